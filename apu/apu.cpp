@@ -52,6 +52,8 @@ static uint32 ratio_numerator = APU_NUMERATOR_NTSC;
 static uint32 ratio_denominator = APU_DENOMINATOR_NTSC;
 
 static double dynamic_rate_multiplier = 1.0;
+
+static uint64 executed = 0; // SMP cycles run, for S9xAPUGetIdleLoopStats()
 } // namespace spc
 
 namespace msu {
@@ -213,6 +215,36 @@ void S9xSetSoundMute(bool8 mute)
         Settings.Mute = true;
 }
 
+void S9xAPUGetBRRCacheStats(uint32 *hits, uint32 *misses)
+{
+    unsigned h, m;
+    SNES::dsp.spc_dsp.brr_cache_stats(&h, &m);
+    *hits = h;
+    *misses = m;
+}
+
+void S9xAPUGetIdleLoopStats(uint64 *skipped, uint64 *total)
+{
+    *skipped = SNES::smp.idle_cycles;
+    *total = spc::executed;
+}
+
+void S9xAPUResetIdleLoopStats(void)
+{
+    SNES::smp.idle_cycles = 0;
+    spc::executed = 0;
+}
+
+const uint8 *S9xAPURAM(void)
+{
+    return SNES::smp.apuram;
+}
+
+uint8 S9xAPUReadDSP(int reg)
+{
+    return SNES::dsp.spc_dsp.read(reg & 0x7f);
+}
+
 void S9xDumpSPCSnapshot(void)
 {
     SNES::dsp.spc_dsp.dump_spc_snapshot();
@@ -271,6 +303,8 @@ void S9xAPUExecute(void)
 {
     int cycles = S9xAPUGetClock(CPU.Cycles);
     spc::remainder = S9xAPUGetClockRemainder(CPU.Cycles);
+    spc::executed += cycles;
+    SNES::smp.clock_base += cycles;
     SNES::smp.clock -= cycles;
     SNES::smp.enter();
 
@@ -449,6 +483,7 @@ void S9xAPULoadBlarggState(uint8 *oldblock)
 
     // blargg's psw has same layout as byuu's flags
     SNES::smp.regs.p = psw;
+    SNES::smp.timers_loaded();
 
     // blargg doesn't explicitly store iplrom_enable
     SNES::smp.status.iplrom_enable = regs[1] & 0x80;
@@ -25,6 +25,11 @@ void S9xAPUTimingSetSpeedup (int);
 void S9xAPULoadState (uint8 *);
 void S9xAPULoadBlarggState(uint8 *oldblock);
 void S9xAPUSaveState (uint8 *);
+void S9xAPUGetBRRCacheStats (uint32 *, uint32 *);
+void S9xAPUGetIdleLoopStats (uint64 *, uint64 *);
+void S9xAPUResetIdleLoopStats (void);
+const uint8 *S9xAPURAM (void);
+uint8 S9xAPUReadDSP (int);
 void S9xDumpSPCSnapshot (void);
 bool8 S9xSPCDump (const char *);
 
@@ -561,9 +561,15 @@ inline void SPC_DSP::run_counters()
 		m.counter = simple_counter_range - 1;
 }
 
+// Rounded-up reciprocals of counter_rates, filled in by init(). The dividend
+// stays below 2^15, so multiplying by these gives the exact quotient.
+static uint64 counter_recips [32];
+
 inline unsigned SPC_DSP::read_counter( int rate )
 {
-	return ((unsigned) m.counter + counter_offsets [rate]) % counter_rates [rate];
+	unsigned const n = (unsigned) m.counter + counter_offsets [rate];
+	unsigned const q = (unsigned) ((n * counter_recips [rate]) >> 32);
+	return n - q * counter_rates [rate];
 }
 
 
@@ -651,6 +657,50 @@ inline void SPC_DSP::run_envelope( voice_t* const v )
 
 //// BRR Decoding
 
+inline bool SPC_DSP::brr_cache_current( brr_cache_t const& e ) const
+{
+	return e.gen [0] == brr_page_gen [e.page [0]] && e.gen [1] == brr_page_gen [e.page [1]];
+}
+
+void SPC_DSP::brr_cache_lookup( voice_t* v, int p1, int p2 )
+{
+	int const addr = v->brr_addr;
+	brr_cache_t& e = brr_cache [((addr * 40503u) & 0xFFFF) >> 7];
+	v->brr_cache = &e - brr_cache + 1;
+
+	if ( e.addr != addr || e.filled < 4 || e.p1 != p1 || e.p2 != p2 || !brr_cache_current( e ) )
+	{
+		// Take entry over and fill it as the block is decoded
+		e.addr    = addr;
+		e.p1      = p1;
+		e.p2      = p2;
+		e.filled  = 0;
+		e.serial++;
+		e.page [0] = addr >> brr_page_shift;
+		e.page [1] = ((addr + brr_block_size - 1) & 0xFFFF) >> brr_page_shift;
+		e.gen  [0] = brr_page_gen [e.page [0]];
+		e.gen  [1] = brr_page_gen [e.page [1]];
+	}
+	v->brr_cache_serial = e.serial;
+}
+
+void SPC_DSP::brr_cache_flush()
+{
+	for ( int i = 0; i < brr_cache_size; i++ )
+	{
+		brr_cache [i].addr   = -1;
+		brr_cache [i].filled = 0;
+	}
+	for ( int i = 0; i < voice_count; i++ )
+		m.voices [i].brr_cache = 0;
+}
+
+void SPC_DSP::brr_cache_stats( unsigned* hits, unsigned* misses ) const
+{
+	*hits   = brr_cache_hits;
+	*misses = brr_cache_misses;
+}
+
 inline void SPC_DSP::decode_brr( voice_t* v )
 {
 	// Arrange the four input nybbles in 0xABCD order for easy decoding
@@ -659,11 +709,47 @@ inline void SPC_DSP::decode_brr( voice_t* v )
 	int const header = m.t_brr_header;
 
 	// Write to next four samples in circular buffer
-	int* pos = &v->buf [v->buf_pos];
+	int* const out = &v->buf [v->buf_pos];
+	int* pos = out;
 	int* end;
 	if ( (v->buf_pos += 4) >= brr_buf_size )
 		v->buf_pos = 0;
 
+	// Blocks are looked up when their first four samples are decoded. The
+	// history only matters as far as the block's filter uses it.
+	int const group = v->brr_offset >> 1;
+	if ( !group )
+	{
+		int const filter = header & 0x0C;
+		brr_cache_lookup( v, filter ? pos [brr_buf_size - 1] : 0,
+				filter >= 8 ? pos [brr_buf_size - 2] : 0 );
+	}
+
+	brr_cache_t* e = 0;
+	if ( v->brr_cache )
+	{
+		// Latched header and byte must also match RAM, as they're read a clock
+		// earlier (and the header is forced to 0 on KON)
+		e = &brr_cache [v->brr_cache - 1];
+		if ( e->serial != v->brr_cache_serial || !brr_cache_current( *e ) ||
+				header != m.ram [v->brr_addr] ||
+				m.t_brr_byte != m.ram [(v->brr_addr + v->brr_offset) & 0xFFFF] )
+		{
+			v->brr_cache = 0;
+			e = 0;
+		}
+	}
+
+	if ( e && e->filled == 4 )
+	{
+		short const* in = &e->samples [group * 4];
+		for ( int i = 0; i < 4; i++ )
+			out [i] = out [i + brr_buf_size] = in [i];
+		brr_cache_hits++;
+		return;
+	}
+	brr_cache_misses++;
+
 	// Decode four samples
 	for ( end = pos + 4; pos < end; pos++, nybbles <<= 4 )
 	{
@@ -707,6 +793,21 @@ inline void SPC_DSP::decode_brr( voice_t* v )
 		s = (int16_t) (s * 2);
 		pos [brr_buf_size] = pos [0] = s; // second copy simplifies wrap-around
 	}
+
+	// Store into entry being filled
+	if ( e )
+	{
+		if ( e->filled == group )
+		{
+			for ( int i = 0; i < 4; i++ )
+				e->samples [group * 4 + i] = (short) out [i];
+			e->filled++;
+		}
+		else
+		{
+			v->brr_cache = 0;
+		}
+	}
 }
 
 
@@ -781,56 +882,47 @@ inline VOICE_CLOCK( V3b )
 	m.t_brr_header = m.ram [v->brr_addr]; // brr_addr doesn't need masking
 }
 
-inline VOICE_CLOCK( V3c )
+inline void SPC_DSP::voice_kon( voice_t* const v )
 {
-	// Pitch modulation using previous voice's output
-	if ( m.t_pmon & v->vbit )
-		m.t_pitch += ((m.t_output >> 5) * m.t_pitch) >> 10;
-
-	if ( v->kon_delay )
+	// Get ready to start BRR decoding on next sample
+	if ( v->kon_delay == 5 )
 	{
-		// Get ready to start BRR decoding on next sample
-		if ( v->kon_delay == 5 )
-		{
-			v->brr_addr    = m.t_brr_next_addr;
-			v->brr_offset  = 1;
-			v->buf_pos     = 0;
-			m.t_brr_header = 0; // header is ignored on this sample
-			m.kon_check    = true;
+		v->brr_addr    = m.t_brr_next_addr;
+		v->brr_offset  = 1;
+		v->buf_pos     = 0;
+		m.t_brr_header = 0; // header is ignored on this sample
+		m.kon_check    = true;
 
-			if (take_spc_snapshot)
-			{
-				take_spc_snapshot = 0;
-				if (spc_snapshot_callback)
-					spc_snapshot_callback();
-			}
+		if (take_spc_snapshot)
+		{
+			take_spc_snapshot = 0;
+			if (spc_snapshot_callback)
+				spc_snapshot_callback();
 		}
+	}
 
-		// Envelope is never run during KON
-		v->env        = 0;
-		v->hidden_env = 0;
-
-		// Disable BRR decoding until last three samples
-		v->interp_pos = 0;
-		if ( --v->kon_delay & 3 )
-			v->interp_pos = 0x4000;
+	// Envelope is never run during KON
+	v->env        = 0;
+	v->hidden_env = 0;
 
-		// Pitch is never added during KON
-		m.t_pitch = 0;
-	}
+	// Disable BRR decoding until last three samples
+	v->interp_pos = 0;
+	if ( --v->kon_delay & 3 )
+		v->interp_pos = 0x4000;
 
-	// Gaussian interpolation
-	{
-		int output = interpolate( v );
+	// Pitch is never added during KON
+	m.t_pitch = 0;
+}
 
-		// Noise
-		if ( m.t_non & v->vbit )
-			output = (int16_t) (m.noise * 2);
+inline void SPC_DSP::voice_envelope( voice_t* const v, int output )
+{
+	// Noise
+	if ( m.t_non & v->vbit )
+		output = (int16_t) (m.noise * 2);
 
-		// Apply envelope
-		m.t_output = (output * v->env) >> 11 & ~1;
-		v->t_envx_out = (uint8_t) (v->env >> 4);
-	}
+	// Apply envelope
+	m.t_output = (output * v->env) >> 11 & ~1;
+	v->t_envx_out = (uint8_t) (v->env >> 4);
 
 	// Immediate silence due to end of sample or soft reset
 	if ( REG(flg) & 0x80 || (m.t_brr_header & 3) == 1 )
@@ -858,6 +950,19 @@ inline VOICE_CLOCK( V3c )
 		run_envelope( v );
 }
 
+inline VOICE_CLOCK( V3c )
+{
+	// Pitch modulation using previous voice's output
+	if ( m.t_pmon & v->vbit )
+		m.t_pitch += ((m.t_output >> 5) * m.t_pitch) >> 10;
+
+	if ( v->kon_delay )
+		voice_kon( v );
+
+	// Gaussian interpolation
+	voice_envelope( v, interpolate( v ) );
+}
+
 inline void SPC_DSP::voice_output( voice_t const* v, int ch )
 {
 	// Apply left/right volume
@@ -1088,7 +1193,11 @@ ECHO_CLOCK( 28 )
 inline void SPC_DSP::echo_write( int ch )
 {
 	if ( !(m.t_echo_enabled & 0x20) )
+	{
 		SET_LE16A( ECHO_PTR( ch ), m.t_echo_out [ch] );
+		if ( !Settings.SeparateEchoBuffer )
+			ram_written( m.t_echo_ptr );
+	}
 
 	m.t_echo_out [ch] = 0;
 }
@@ -1115,6 +1224,145 @@ ECHO_CLOCK( 30 )
 }
 
 
+//// Fast mode
+
+// With Settings.FastDSP, run() produces one whole output sample at a time
+// instead of stepping the 32-clock pipeline: every voice is fetched, then
+// interpolated in a single pass, then enveloped, decoded and mixed in voice
+// order (PMON needs the previous voice's output), and the echo FIR is one
+// 8-tap loop. Registers are sampled once per sample rather than on their
+// exact clock, so output is close to but not bit-identical with the default.
+
+inline void SPC_DSP::echo_fir()
+{
+	// History
+	if ( ++m.echo_hist_pos >= &m.echo_hist [echo_hist_size] )
+		m.echo_hist_pos = m.echo_hist;
+
+	m.t_echo_ptr = (m.t_esa * 0x100 + m.echo_offset) & 0xFFFF;
+	echo_read( 0 );
+	echo_read( 1 );
+
+	// Same sums as echo_22 ... echo_25, including the 16-bit wrap before the last tap
+	int l = 0;
+	int r = 0;
+	for ( int i = 0; i < echo_hist_size - 1; i++ )
+	{
+		l += CALC_FIR( i, 0 );
+		r += CALC_FIR( i, 1 );
+	}
+
+	l = (int16_t) l;
+	r = (int16_t) r;
+
+	l += (int16_t) CALC_FIR( 7, 0 );
+	r += (int16_t) CALC_FIR( 7, 1 );
+
+	CLAMP16( l );
+	CLAMP16( r );
+
+	m.t_echo_in [0] = l & ~1;
+	m.t_echo_in [1] = r & ~1;
+}
+
+void SPC_DSP::run_fast_sample()
+{
+	misc_27();
+	misc_28();
+	misc_29();
+	misc_30();
+
+	int  next_addr [voice_count];
+	int  header    [voice_count];
+	int  pitch     [voice_count];
+	int  output    [voice_count];
+	bool kon       [voice_count];
+
+	// Directory entry, pitch and BRR header, then KON setup
+	for ( int i = 0; i < voice_count; i++ )
+	{
+		voice_t* const v = &m.voices [i];
+
+		uint8_t const* entry = &m.ram [(m.t_dir * 0x100 + VREG(v->regs,srcn) * 4) & 0xFFFF];
+		if ( !v->kon_delay )
+			entry += 2;
+		m.t_brr_next_addr = next_addr [i] = GET_LE16A( entry );
+		m.t_brr_header    = m.ram [v->brr_addr];
+		pitch [i] = VREG(v->regs,pitchl) + ((VREG(v->regs,pitchh) & 0x3F) << 8);
+
+		kon [i] = v->kon_delay != 0;
+		if ( kon [i] )
+			voice_kon( v );
+		header [i] = m.t_brr_header;
+	}
+
+	// Interpolation doesn't depend on other voices, so do all eight at once.
+	// A voice with no envelope contributes nothing, so it isn't interpolated.
+	int const method = Settings.InterpolationMethod;
+	if ( method == 0 || method == 1 || method == 3 || method == 4 )
+	{
+		for ( int i = 0; i < voice_count; i++ )
+			output [i] = m.voices [i].env ? interpolate( &m.voices [i] ) : 0;
+	}
+	else
+	{
+		// Gaussian, as in interpolate()
+		for ( int i = 0; i < voice_count; i++ )
+		{
+			voice_t const* v = &m.voices [i];
+			if ( !v->env )
+			{
+				output [i] = 0;
+				continue;
+			}
+
+			int const* in = &v->buf [(v->interp_pos >> 12) + v->buf_pos];
+			int offset = v->interp_pos >> 4 & 0xFF;
+
+			int out = (gauss [255 - offset] * in [0]) >> 11;
+			out += (gauss [511 - offset] * in [1]) >> 11;
+			out += (gauss [256 + offset] * in [2]) >> 11;
+			out = (int16_t) out;
+			out += (gauss [      offset] * in [3]) >> 11;
+
+			CLAMP16( out );
+			output [i] = out & ~1;
+		}
+	}
+
+	for ( int i = 0; i < voice_count; i++ )
+	{
+		voice_t* const v = &m.voices [i];
+
+		m.t_pitch = pitch [i];
+		if ( m.t_pmon & v->vbit )
+			m.t_pitch += ((m.t_output >> 5) * m.t_pitch) >> 10;
+		if ( kon [i] )
+			m.t_pitch = 0;
+
+		m.t_adsr0         = VREG(v->regs,adsr0);
+		m.t_brr_header    = header [i];
+		m.t_brr_next_addr = next_addr [i];
+		m.t_brr_byte      = m.ram [(v->brr_addr + v->brr_offset) & 0xFFFF];
+
+		voice_envelope( v, output [i] );
+		voice_V4( v );
+		voice_V5( v );
+		voice_V6( v );
+		voice_V7( v );
+		voice_V8( v );
+		voice_V9( v );
+	}
+
+	echo_fir();
+	echo_26();
+	echo_27();
+	echo_28();
+	echo_29();
+	echo_30();
+}
+
+
 //// Timing
 
 // Execute clock for a particular voice
@@ -1169,6 +1417,15 @@ void SPC_DSP::run( int clocks_remain )
 {
 	require( clocks_remain > 0 );
 
+	if ( Settings.FastDSP )
+	{
+		int const clocks = m.phase + clocks_remain;
+		m.phase = clocks & 31;
+		for ( int n = clocks >> 5; n; n-- )
+			run_fast_sample();
+		return;
+	}
+
 	int const phase = m.phase;
 	m.phase = (phase + clocks_remain) & 31;
 	switch ( phase )
@@ -1193,6 +1450,12 @@ void SPC_DSP::init( void* ram_64k )
 {
 	m.ram = (uint8_t*) ram_64k;
 	mute_voices( 0 );
+
+	for ( int i = 0; i < 32; i++ )
+		counter_recips [i] = ((uint64) 1 << 32) / counter_rates [i] + 1;
+	memset( brr_page_gen, 0, sizeof brr_page_gen );
+	brr_cache_hits   = 0;
+	brr_cache_misses = 0;
 	disable_surround( false );
 	set_output( 0, 0 );
 	reset();
@@ -1262,6 +1525,7 @@ void SPC_DSP::load( uint8_t const regs [register_count] )
 	m.t_dir   = REG(dir);
 	m.t_esa   = REG(esa);
 
+	brr_cache_flush();
 	soft_reset_common();
 }
 
@@ -1410,6 +1674,9 @@ void SPC_DSP::copy_state( unsigned char** io, copy_func_t copy )
 
 	copier.copy(m.external_regs, register_count);
 	copier.extra();
+
+	// RAM is restored alongside the DSP state
+	brr_cache_flush();
 }
 #endif
 
@@ -67,6 +67,18 @@ public:
 	// Returns non-zero if new key-on events occurred since last call
 	bool check_kon();
 
+// Decoded BRR cache
+
+	// Must be called for every write to the 64K RAM that changes its contents,
+	// other than those made by the DSP itself
+	void ram_written( int addr );
+
+	// Discards all decoded blocks; call after replacing RAM wholesale
+	void brr_cache_flush();
+
+	// Number of 4-sample decode groups served from/missed by the cache
+	void brr_cache_stats( unsigned* hits, unsigned* misses ) const;
+
 // Snes9x Accessor
 
 	int     stereo_switch;
@@ -133,10 +145,32 @@ public:
 		int hidden_env;         // used by GAIN mode 7, very obscure quirk
 		uint8_t t_envx_out;
 		int voice_number;
+		int brr_cache;          // cache entry + 1 of the block being decoded, 0 if none
+		unsigned brr_cache_serial;
 	};
 private:
 	enum { brr_block_size = 9 };
 
+	// Decoded BRR blocks, keyed by block address and the filter history they
+	// were decoded from. Each entry remembers the generation of the RAM pages
+	// its 9 bytes live on, so any later write to them turns it into a miss.
+	enum { brr_cache_size = 512 };
+	enum { brr_page_shift = 6 };
+	struct brr_cache_t
+	{
+		int addr;               // block address, -1 if unused
+		int p1, p2;             // filter history before the first sample
+		int filled;             // decode groups stored so far (4 when complete)
+		unsigned serial;        // bumped whenever the entry is reused
+		unsigned short page [2];
+		unsigned gen [2];
+		short samples [16];
+	};
+	brr_cache_t brr_cache [brr_cache_size];
+	unsigned brr_page_gen [0x10000 >> brr_page_shift];
+	unsigned brr_cache_hits;
+	unsigned brr_cache_misses;
+
 	Resampler *resampler;
 
 	struct state_t
@@ -216,12 +250,16 @@ private:
 	int  interpolate( voice_t const* v );
 	void run_envelope( voice_t* const v );
 	void decode_brr( voice_t* v );
+	bool brr_cache_current( brr_cache_t const& ) const;
+	void brr_cache_lookup( voice_t* v, int p1, int p2 );
 
 	void misc_27();
 	void misc_28();
 	void misc_29();
 	void misc_30();
 
+	void voice_kon( voice_t* const );
+	void voice_envelope( voice_t* const, int output );
 	void voice_output( voice_t const* v, int ch );
 	void voice_V1( voice_t* const );
 	void voice_V2( voice_t* const );
@@ -251,6 +289,9 @@ private:
 	void echo_28();
 	void echo_29();
 	void echo_30();
+	void echo_fir();
+
+	void run_fast_sample();
 
 	void soft_reset_common();
 };
@@ -296,6 +337,8 @@ inline void SPC_DSP::write( int addr, int data )
 
 inline void SPC_DSP::mute_voices( int mask ) { m.mute_mask = mask; }
 
+inline void SPC_DSP::ram_written( int addr ) { brr_page_gen [(addr & 0xFFFF) >> brr_page_shift]++; }
+
 inline bool SPC_DSP::check_kon()
 {
 	bool old = m.kon_check;
@@ -1,17 +1,9 @@
 void SMP::tick() {
-  timer0.tick();
-  timer1.tick();
-  timer2.tick();
-
   clock++;
   dsp.clock++;
 }
 
 void SMP::tick(unsigned clocks) {
-  timer0.tick(clocks);
-  timer1.tick(clocks);
-  timer2.tick(clocks);
-
   clock += clocks;
   dsp.clock += clocks;
 }
@@ -34,6 +26,7 @@ uint8 SMP::op_read(uint16 addr) {
 void SMP::op_write(uint16 addr, uint8 data) {
   tick();
   if((addr & 0xfff0) == 0x00f0) mmio_write(addr, data);
+  if(apuram[addr] != data) dsp.spc_dsp.ram_written(addr);
   apuram[addr] = data;  //all writes go to RAM, even MMIO writes
 }
 
@@ -46,6 +39,7 @@ uint8 SMP::op_readstack()
 void SMP::op_writestack(uint8 data)
 {
   tick();
+  if(apuram[0x0100 | regs.sp] != data) dsp.spc_dsp.ram_written(0x0100 | regs.sp);
   apuram[0x0100 | regs.sp--] = data;
 }
 
@@ -0,0 +1,174 @@
+#ifdef SMP_CPP
+
+//Sound drivers spend most of their time spinning in a short loop on the
+//ports from the CPU or on a timer output. Those can't change while enter()
+//runs, except for the timer ticking, so once the loop has come round twice
+//to the same state every further pass is the same too. idle_loop() then
+//moves the clock forward by whole passes, up to the end of this enter() or
+//the next tick of a timer the loop reads.
+
+#define IDLE_LOOP_BYTES 16
+
+uint8 SMP::idle_peek(uint16 addr) {
+  if(addr >= 0xffc0 && status.iplrom_enable) return iplrom[addr & 0x3f];
+  return apuram[addr];
+}
+
+//checks the instructions from start up to and including the jump back at
+//branch; they may only read, and only what stays the same for the rest of
+//enter(). returns -1 if the loop never qualifies, 0 if it doesn't with the
+//current registers. *timers gets a bit for each timer output read.
+int SMP::idle_body(uint16 start, uint16 branch, unsigned *timers) {
+  uint16 pc = start;
+  uint16 page = regs.p.p << 8;
+
+  //code in $00f0-$00ff would run from the registers
+  if((uint16)(start - 0x00f0) < 0x10 || (uint16)(0x00f0 - start) < (uint16)(branch + 3 - start)) return -1;
+
+  for(;;) {
+    uint8 op = idle_peek(pc);
+    uint8 op1 = idle_peek(pc + 1);
+    uint8 op2 = idle_peek(pc + 2);
+    uint16 abs = op1 | op2 << 8;
+    unsigned length;
+    int reads = 1;
+    uint16 addr[2];
+
+    if(pc == branch) {
+      switch(op) {
+      case 0x2f: case 0xf0: case 0xd0: case 0xb0: case 0x90:  //bra beq bne bcs bcc
+      case 0x70: case 0x50: case 0x30: case 0x10:             //bvs bvc bmi bpl
+        length = 2; reads = 0; break;
+      case 0x5f:                                              //jmp !abs
+        length = 3; reads = 0; break;
+      case 0xef: case 0xff:                                   //sleep stop
+        length = 1; reads = 0; break;
+      case 0x2e:                                              //cbne dp
+        length = 3; addr[0] = page + op1; break;
+      case 0xde:                                              //cbne dp+x
+        length = 3; addr[0] = page + (uint8)(op1 + regs.x); break;
+      default:
+        if((op & 0x0f) != 0x03) return -1;                    //bbs bbc
+        length = 3; addr[0] = page + op1; break;
+      }
+    } else {
+      switch(op) {
+      case 0x00: case 0x60: case 0x80: case 0xe0:             //nop clrc setc clrv
+      case 0x7d: case 0xdd: case 0x5d: case 0xfd:             //mov a,x a,y x,a y,a
+        length = 1; reads = 0; break;
+      case 0xe8: case 0xcd: case 0x8d: case 0x68: case 0xc8:  //#imm
+      case 0xad: case 0x28: case 0x08: case 0x48:
+        length = 2; reads = 0; break;
+      case 0xe4: case 0xf8: case 0xeb: case 0x64: case 0x3e:  //dp
+      case 0x7e: case 0x24: case 0x04: case 0x44:
+        length = 2; addr[0] = page + op1; break;
+      case 0xba: case 0x5a:                                   //movw cmpw ya,dp
+        length = 2; addr[0] = page + op1; addr[1] = page + (uint8)(op1 + 1); reads = 2; break;
+      case 0x78:                                              //cmp dp,#imm
+        length = 3; addr[0] = page + op2; break;
+      case 0x69:                                              //cmp dp,dp
+        length = 3; addr[0] = page + op1; addr[1] = page + op2; reads = 2; break;
+      case 0xf4: case 0x74: case 0xfb:                        //dp+x
+        length = 2; addr[0] = page + (uint8)(op1 + regs.x); break;
+      case 0xf9:                                              //dp+y
+        length = 2; addr[0] = page + (uint8)(op1 + regs.B.y); break;
+      case 0xe6: case 0x66:                                   //(x)
+        length = 1; addr[0] = page + regs.x; break;
+      case 0xe5: case 0xe9: case 0xec: case 0x65: case 0x1e:  //!abs
+      case 0x5e: case 0x25: case 0x05: case 0x45:
+        length = 3; addr[0] = abs; break;
+      case 0xf5: case 0x75:                                   //!abs+x
+        length = 3; addr[0] = abs + regs.x; break;
+      case 0xf6: case 0x76:                                   //!abs+y
+        length = 3; addr[0] = abs + regs.B.y; break;
+      default:
+        return -1;
+      }
+    }
+
+    for(int n = 0; n < reads; n++) {
+      uint16 a = addr[n];
+      if((a & 0xfff0) != 0x00f0) continue;
+      if(a == 0x00f3) return 0;  //DSP registers change as it runs
+      if(a >= 0x00fd) *timers |= 1 << (a - 0x00fd);
+    }
+
+    if(pc == branch) return 1;
+    pc += length;
+    if((uint16)(pc - start) > (uint16)(branch - start)) return -1;
+  }
+}
+
+//A timer output read gives 0 in every pass only while the timer doesn't tick,
+//and only if a pass already ran without a tick since the state was recorded;
+//the first pass may have cleared one from before. Lowers limit to the next
+//tick, or starts over with false if the loop can't be skipped yet.
+template<unsigned cycle_frequency>
+bool SMP::idle_timer(Timer<cycle_frequency> &timer, uint32 now, int32 &limit) {
+  timer.update(now);
+  if(timer.stage3_ticks == 0) {
+    if(timer.enable == false) return true;
+    uint32 next = timer.next_output(now);
+    if((int32)(next - timer.output_period() - idle.since) <= 0) {
+      if((int32)(next - now) < limit - clock) limit = clock + (int32)(next - now);
+      return true;
+    }
+  }
+  idle.passes = 0;
+  idle.since = now;
+  return false;
+}
+
+//called after a jump from branch back to regs.pc, at most IDLE_LOOP_BYTES
+void SMP::idle_loop(uint16 branch) {
+  if(branch == idle.unsafe) return;
+
+  bool same = idle.armed && idle.branch == branch
+    && idle.regs.pc == regs.pc && idle.regs.sp == regs.sp && idle.regs.ya == regs.ya
+    && idle.regs.x == regs.x && (unsigned)idle.regs.p == (unsigned)regs.p
+    && idle.rd == rd && idle.wr == wr && idle.dp == dp && idle.sp == sp
+    && idle.ya == ya && idle.bit == bit;
+  int32 last = idle.clock;
+
+  idle.clock = clock;
+  if(!same) {
+    idle.armed = true;
+    idle.branch = branch;
+    idle.passes = 0;
+    idle.since = time();
+    idle.regs = regs;
+    idle.rd = rd; idle.wr = wr; idle.dp = dp;
+    idle.sp = sp; idle.ya = ya; idle.bit = bit;
+    return;
+  }
+
+  idle.passes++;
+
+  unsigned timers = 0;
+  int body = idle_body(regs.pc, branch, &timers);
+  if(body <= 0) {
+    if(body < 0) idle.unsafe = branch;
+    return;
+  }
+
+  int32 period = clock - last;
+  int32 limit = 0;
+  uint32 now = time();
+
+  if(timers) {
+    if(idle.passes < 2) return;
+    if(timers & 1 && !idle_timer(timer0, now, limit)) return;
+    if(timers & 2 && !idle_timer(timer1, now, limit)) return;
+    if(timers & 4 && !idle_timer(timer2, now, limit)) return;
+  }
+
+  if(period <= 0 || clock + period >= limit) return;
+
+  int32 skipped = (limit - 1 - clock) / period * period;
+  clock += skipped;
+  dsp.clock += skipped;
+  idle.clock = clock;
+  idle_cycles += skipped;
+}
+
+#endif
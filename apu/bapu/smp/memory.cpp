@@ -3,6 +3,7 @@ unsigned SMP::port_read(unsigned addr) {
 }
 
 void SMP::port_write(unsigned addr, unsigned data) {
+  dsp.spc_dsp.ram_written(0xf4);
   apuram[0xf4 + (addr & 3)] = data;
 }
 
@@ -28,18 +29,21 @@ unsigned SMP::mmio_read(unsigned addr) {
     return status.ram00f9;
 
   case 0xfd: {
+    timer0.update(time());
     unsigned result = timer0.stage3_ticks & 15;
     timer0.stage3_ticks = 0;
     return result;
   }
 
   case 0xfe: {
+    timer1.update(time());
     unsigned result = timer1.stage3_ticks & 15;
     timer1.stage3_ticks = 0;
     return result;
   }
 
   case 0xff: {
+    timer2.update(time());
     unsigned result = timer2.stage3_ticks & 15;
     timer2.stage3_ticks = 0;
     return result;
@@ -54,6 +58,9 @@ void SMP::mmio_write(unsigned addr, unsigned data) {
   switch(addr) {
 
   case 0xf1:
+    timer0.update(time());
+    timer1.update(time());
+    timer2.update(time());
     status.iplrom_enable = data & 0x80;
 
     if(data & 0x30) {
@@ -112,14 +119,17 @@ void SMP::mmio_write(unsigned addr, unsigned data) {
     break;
 
   case 0xfa:
+    timer0.update(time());
     timer0.target = data;
     break;
 
   case 0xfb:
+    timer1.update(time());
     timer1.target = data;
     break;
 
   case 0xfc:
+    timer2.update(time());
     timer2.target = data;
     break;
   }
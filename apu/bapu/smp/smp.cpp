@@ -20,13 +20,47 @@ SMP smp;
 #include "iplrom.cpp"
 #include "memory.cpp"
 #include "timing.cpp"
+#include "idle.cpp"
 
 void SMP::enter() {
-  while(clock < 0) op_step();
+  idle.armed = false;
+
+  //timer.time may be at most 2^31 cycles behind time()
+  if(time() - timer0.time >= 0x40000000 || time() - timer1.time >= 0x40000000
+  || time() - timer2.time >= 0x40000000) timers_update();
+
+  if(!Settings.IdleLoopSkip) {
+    while(clock < 0) op_step();
+    return;
+  }
+
+  while(clock < 0) {
+    if(opcode_cycle) {
+      op_step();
+      continue;
+    }
+    uint16 pc = regs.pc;
+    op_step();
+    if((uint16)(pc - regs.pc) <= IDLE_LOOP_BYTES) idle_loop(pc);
+  }
+}
+
+void SMP::timers_update() {
+  timer0.update(time());
+  timer1.update(time());
+  timer2.update(time());
+}
+
+//the timers' stages were set directly, as of the current time()
+void SMP::timers_loaded() {
+  timer0.time = timer1.time = timer2.time = time();
+  idle.armed = false;
 }
 
 void SMP::power() {
   Processor::clock = 0;
+  clock_base = 0;
+  idle.unsafe = 0;
 
   timer0.target = 0;
   timer1.target = 0;
@@ -37,6 +71,7 @@ void SMP::power() {
 
 void SMP::reset() {
   for(unsigned n = 0x0000; n <= 0xffff; n++) apuram[n] = 0x00;
+  dsp.spc_dsp.brr_cache_flush();
 
   opcode_number = 0;
   opcode_cycle = 0;
@@ -63,6 +98,7 @@ void SMP::reset() {
   timer0.stage1_ticks = timer1.stage1_ticks = timer2.stage1_ticks = 0;
   timer0.stage2_ticks = timer1.stage2_ticks = timer2.stage2_ticks = 0;
   timer0.stage3_ticks = timer1.stage3_ticks = timer2.stage3_ticks = 0;
+  timers_loaded();
 }
 
 SMP::SMP() {
@@ -12,6 +12,8 @@ public:
   void enter();
   void power();
   void reset();
+  void timers_update();
+  void timers_loaded();
 
   void load_state(uint8 **);
   void save_state(uint8 **);
@@ -71,6 +73,8 @@ public:
     unsigned ram00f9;
   } status;
 
+  //the timers aren't ticked every cycle; update() catches a timer up to the
+  //given time() before $00f1, $00fa-$00fc or its $00fd-$00ff is accessed
   template<unsigned frequency>
   struct Timer {
     bool enable;
@@ -78,15 +82,41 @@ public:
     uint8 stage1_ticks;
     uint8 stage2_ticks;
     uint8 stage3_ticks;
+    uint32 time;  //time() the stages were last updated to
 
-    inline void tick();
-    inline void tick(unsigned clocks);
+    inline void update(uint32 now);
+    inline uint32 next_output(uint32 now) const;
+    inline uint32 period() const;
+    inline uint32 output_period() const { return period() * frequency; }
   };
 
   Timer<128> timer0;
   Timer<128> timer1;
   Timer< 16> timer2;
 
+  //clock is relative to the CPU and rebased by S9xAPUExecute(); clock_base
+  //moves the other way, so time() counts SMP cycles
+  uint32 clock_base;
+  alwaysinline uint32 time() const { return clock_base + (uint32)clock; }
+
+  //idle loop skipping, see idle.cpp
+  struct IdleLoop {
+    bool armed;
+    uint16 branch;    //address of the jump back to the loop's start
+    uint16 unsafe;    //last branch whose loop can't be skipped
+    int32 clock;      //when it was last taken
+    unsigned passes;  //taken since the state was recorded
+    uint32 since;     //time() the state was recorded
+    Regs regs;
+    uint16 rd, wr, dp, sp, ya, bit;
+  } idle;
+  uint64 idle_cycles;
+
+  alwaysinline void idle_loop(uint16 branch);
+  int idle_body(uint16 start, uint16 branch, unsigned *timers);
+  template<unsigned cycle_frequency> bool idle_timer(Timer<cycle_frequency> &timer, uint32 now, int32 &limit);
+  alwaysinline uint8 idle_peek(uint16 addr);
+
   inline void tick();
   inline void tick(unsigned clocks);
   alwaysinline void op_io();
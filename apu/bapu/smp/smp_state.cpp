@@ -72,6 +72,7 @@ void SMP::save_spc (uint8 *block) {
 
 void SMP::save_state(uint8 **block) {
   uint8 *ptr = *block;
+  timers_update();
   memcpy(ptr, apuram, 64 * 1024);
   ptr += 64 * 1024;
 
@@ -191,6 +192,7 @@ void SMP::load_state(uint8 **block) {
   INT32(ya);
   INT32(bit);
 
+  timers_loaded();
   *block = ptr;
 }
 
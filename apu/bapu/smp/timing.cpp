@@ -1,26 +1,36 @@
 template<unsigned cycle_frequency>
-void SMP::Timer<cycle_frequency>::tick() {
-  if(++stage1_ticks < cycle_frequency) return;
+void SMP::Timer<cycle_frequency>::update(uint32 now) {
+  unsigned clocks = now - time;
+  time = now;
 
-  stage1_ticks = 0;
+  clocks += stage1_ticks;
+  stage1_ticks = clocks % cycle_frequency;
   if(enable == false) return;
 
-  if(++stage2_ticks != target) return;
+  //stage2 counts up to target, wrapping at 256 on the way if it is past it
+  unsigned ticks = clocks / cycle_frequency;
+  unsigned first = (uint8)(target - stage2_ticks);
+  if(first == 0) first = 256;
+  if(ticks < first) {
+    stage2_ticks += ticks;
+    return;
+  }
 
-  stage2_ticks = 0;
-  stage3_ticks = (stage3_ticks + 1) & 15;
+  ticks -= first;
+  stage2_ticks = ticks % period();
+  stage3_ticks = (stage3_ticks + 1 + ticks / period()) & 15;
 }
 
+//stage2 ticks between two stage3 ticks
 template<unsigned cycle_frequency>
-void SMP::Timer<cycle_frequency>::tick(unsigned clocks) {
-  stage1_ticks += clocks;
-  if(stage1_ticks < cycle_frequency) return;
-
-  stage1_ticks -= cycle_frequency;
-  if(enable == false) return;
-
-  if(++stage2_ticks != target) return;
+uint32 SMP::Timer<cycle_frequency>::period() const {
+  return target ? target : 256;
+}
 
-  stage2_ticks = 0;
-  stage3_ticks = (stage3_ticks + 1) & 15;
+//the time() at which stage3 next ticks; call update(now) first
+template<unsigned cycle_frequency>
+uint32 SMP::Timer<cycle_frequency>::next_output(uint32 now) const {
+  unsigned first = (uint8)(target - stage2_ticks);
+  if(first == 0) first = 256;
+  return now + first * cycle_frequency - stage1_ticks;
 }
@@ -250,6 +250,7 @@ static void fx_readRegisterSpace (void)
 	GSU.pvRamBank = GSU.apvRamBank[GSU.vRamBankReg & 0x3];
 	GSU.pvRomBank = GSU.apvRomBank[GSU.vRomBankReg];
 	GSU.pvPrgBank = GSU.apvRomBank[GSU.vPrgBankReg];
+	FX_PLOT_THROUGH;
 
 	// Set screen pointers
 	GSU.pvScreenBase = &GSU.pvRam[USEX8(p[GSU_SCBR]) << 10];
@@ -22,6 +22,58 @@
    (xx) = 16 bit address (0x0000 - 0xffff)
 */
 
+// PLOT doesn't write each pixel straight to the bitplanes. Like the GSU's own
+// pixel cache, it collects the pixels of one 8-pixel row and writes them out
+// together when a pixel lands in another row. The row is flushed before GSU
+// RAM is read or written and at the end of fx_run(), so nothing can tell.
+// While code or R14 data comes from a RAM bank, pixels are written at once.
+
+static const uint8	fx_planeOffset[8] = { 0x00, 0x01, 0x10, 0x11, 0x20, 0x21, 0x30, 0x31 };
+
+// Multiplying the bits of one plane, one per byte, by this gathers them into
+// the top byte with the leftmost pixel in bit 7
+#ifdef LSB_FIRST
+#define FX_PLANE_GATHER	0x8040201008040201ull
+#else
+#define FX_PLANE_GATHER	0x0102040810204080ull
+#endif
+
+static void fx_flushPlot (void)
+{
+	uint64	pix;
+	uint8	*a = GSU.pvPlotRow;
+	uint8	m = (uint8) GSU.vPlotMask;
+
+	memcpy(&pix, GSU.avPlotPixels, 8);
+
+	for (uint32 i = 0; i < GSU.vPlotPlanes; i++)
+	{
+		uint8	b = (uint8) ((((pix >> i) & 0x0101010101010101ull) * FX_PLANE_GATHER) >> 56);
+		a[fx_planeOffset[i]] = (a[fx_planeOffset[i]] & ~m) | (b & m);
+	}
+
+	GSU.vPlotMask = 0;
+	GSU.pvPlotRow = nullptr;
+}
+
+#define FX_FLUSH_PLOT	if (GSU.vPlotMask) fx_flushPlot()
+
+static inline void fx_plotPixel (uint8 *a, uint32 x, uint8 c, uint32 planes)
+{
+	if (a != GSU.pvPlotRow)
+	{
+		FX_FLUSH_PLOT;
+		GSU.pvPlotRow = a;
+		GSU.vPlotPlanes = planes;
+	}
+
+	GSU.avPlotPixels[x & 7] = c;
+	GSU.vPlotMask |= 128 >> (x & 7);
+
+	if (GSU.bPlotThrough)
+		fx_flushPlot();
+}
+
 // 00 - stop - stop GSU execution (and maybe generate an IRQ)
 static void fx_stop (void)
 {
@@ -393,6 +445,7 @@ static void fx_with_r15 (void)
 
 // 30-3b - stw (rn) - store word
 #define FX_STW(reg) \
+	FX_FLUSH_PLOT; \
 	GSU.vLastRamAdr = GSU.avReg[reg]; \
 	RAM(GSU.avReg[reg]) = (uint8) SREG; \
 	RAM(GSU.avReg[reg] ^ 1) = (uint8) (SREG >> 8); \
@@ -461,6 +514,7 @@ static void fx_stw_r11 (void)
 
 // 30-3b (ALT1) - stb (rn) - store byte
 #define FX_STB(reg) \
+	FX_FLUSH_PLOT; \
 	GSU.vLastRamAdr = GSU.avReg[reg]; \
 	RAM(GSU.avReg[reg]) = (uint8) SREG; \
 	CLRFLAGS; \
@@ -564,6 +618,7 @@ static void fx_alt3 (void)
 
 // 40-4b - ldw (rn) - load word from RAM
 #define FX_LDW(reg) \
+	FX_FLUSH_PLOT; \
 	uint32	v; \
 	GSU.vLastRamAdr = GSU.avReg[reg]; \
 	v = (uint32) RAM(GSU.avReg[reg]); \
@@ -635,6 +690,7 @@ static void fx_ldw_r11 (void)
 
 // 40-4b (ALT1) - ldb (rn) - load byte
 #define FX_LDB(reg) \
+	FX_FLUSH_PLOT; \
 	uint32	v; \
 	GSU.vLastRamAdr = GSU.avReg[reg]; \
 	v = (uint32) RAM(GSU.avReg[reg]); \
@@ -709,7 +765,7 @@ static void fx_plot_2bit (void)
 	uint32	x = USEX8(R1);
 	uint32	y = USEX8(R2);
 	uint8	*a;
-	uint8	v, c;
+	uint8	c;
 
 	R15++;
 	CLRFLAGS;
@@ -729,17 +785,7 @@ static void fx_plot_2bit (void)
 		c = (uint8) GSU.vColorReg;
 
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
-	v = 128 >> (x & 7);
-
-	if (c & 0x01)
-		a[0] |=  v;
-	else
-		a[0] &= ~v;
-
-	if (c & 0x02)
-		a[1] |=  v;
-	else
-		a[1] &= ~v;
+	fx_plotPixel(a, x, c, 2);
 }
 
 // 4c (ALT1) - rpix - read color of the pixel with R1, R2 as x, y
@@ -752,6 +798,7 @@ static void fx_rpix_2bit (void)
 
 	R15++;
 	CLRFLAGS;
+	FX_FLUSH_PLOT;
 
 #ifdef CHECK_LIMITS
 	if (y >= GSU.vScreenHeight)
@@ -773,7 +820,7 @@ static void fx_plot_4bit (void)
 	uint32	x = USEX8(R1);
 	uint32	y = USEX8(R2);
 	uint8	*a;
-	uint8	v, c;
+	uint8	c;
 
 	R15++;
 	CLRFLAGS;
@@ -793,27 +840,7 @@ static void fx_plot_4bit (void)
 		c = (uint8) GSU.vColorReg;
 
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
-	v = 128 >> (x & 7);
-
-	if (c & 0x01)
-		a[0x00] |=  v;
-	else
-		a[0x00] &= ~v;
-
-	if (c & 0x02)
-		a[0x01] |=  v;
-	else
-		a[0x01] &= ~v;
-
-	if (c & 0x04)
-		a[0x10] |=  v;
-	else
-		a[0x10] &= ~v;
-
-	if (c & 0x08)
-		a[0x11] |=  v;
-	else
-		a[0x11] &= ~v;
+	fx_plotPixel(a, x, c, 4);
 }
 
 // 4c (ALT1) - rpix - read color of the pixel with R1, R2 as x, y
@@ -826,6 +853,7 @@ static void fx_rpix_4bit (void)
 
 	R15++;
 	CLRFLAGS;
+	FX_FLUSH_PLOT;
 
 #ifdef CHECK_LIMITS
 	if (y >= GSU.vScreenHeight)
@@ -849,7 +877,7 @@ static void fx_plot_8bit (void)
 	uint32	x = USEX8(R1);
 	uint32	y = USEX8(R2);
 	uint8	*a;
-	uint8	v, c;
+	uint8	c;
 
 	R15++;
 	CLRFLAGS;
@@ -871,47 +899,7 @@ static void fx_plot_8bit (void)
 		return;
 
 	a = GSU.apvScreen[y >> 3] + GSU.x[x >> 3] + ((y & 7) << 1);
-	v = 128 >> (x & 7);
-
-	if (c & 0x01)
-		a[0x00] |=  v;
-	else
-		a[0x00] &= ~v;
-
-	if (c & 0x02)
-		a[0x01] |=  v;
-	else
-		a[0x01] &= ~v;
-
-	if (c & 0x04)
-		a[0x10] |=  v;
-	else
-		a[0x10] &= ~v;
-
-	if (c & 0x08)
-		a[0x11] |=  v;
-	else
-		a[0x11] &= ~v;
-
-	if (c & 0x10)
-		a[0x20] |=  v;
-	else
-		a[0x20] &= ~v;
-
-	if (c & 0x20)
-		a[0x21] |=  v;
-	else
-		a[0x21] &= ~v;
-
-	if (c & 0x40)
-		a[0x30] |=  v;
-	else
-		a[0x30] &= ~v;
-
-	if (c & 0x80)
-		a[0x31] |=  v;
-	else
-		a[0x31] &= ~v;
+	fx_plotPixel(a, x, c, 8);
 }
 
 // 4c (ALT1) - rpix - read color of the pixel with R1, R2 as x, y
@@ -924,6 +912,7 @@ static void fx_rpix_8bit (void)
 
 	R15++;
 	CLRFLAGS;
+	FX_FLUSH_PLOT;
 
 #ifdef CHECK_LIMITS
 	if (y >= GSU.vScreenHeight)
@@ -2487,6 +2476,7 @@ static void fx_umult_i15 (void)
 // 90 - sbk - store word to last accessed RAM address
 static void fx_sbk (void)
 {
+	FX_FLUSH_PLOT;
 	RAM(GSU.vLastRamAdr) = (uint8) SREG;
 	RAM(GSU.vLastRamAdr ^ 1) = (uint8) (SREG >> 8);
 	CLRFLAGS;
@@ -2615,8 +2605,10 @@ static void fx_jmp_r13 (void)
 
 // 98-9d (ALT1) - ljmp rn - set program bank to source register and jump to address of register
 #define FX_LJMP(reg) \
+	FX_FLUSH_PLOT; \
 	GSU.vPrgBankReg = GSU.avReg[reg] & 0x7f; \
 	GSU.pvPrgBank = GSU.apvRomBank[GSU.vPrgBankReg]; \
+	FX_PLOT_THROUGH; \
 	R15 = SREG; \
 	GSU.bCacheActive = false; \
 	fx_cache(); \
@@ -2788,6 +2780,7 @@ static void fx_ibt_r15 (void)
 
 // a0-af (ALT1) - lms rn, (yy) - load word from RAM (short address)
 #define FX_LMS(reg) \
+	FX_FLUSH_PLOT; \
 	GSU.vLastRamAdr = ((uint32) PIPE) << 1; \
 	R15++; \
 	FETCHPIPE; \
@@ -2881,6 +2874,7 @@ static void fx_lms_r15 (void)
 // XXX: If rn == r15, is the value of r15 before or after the extra byte is read ?
 #define FX_SMS(reg) \
 	uint32	v = GSU.avReg[reg]; \
+	FX_FLUSH_PLOT; \
 	GSU.vLastRamAdr = ((uint32) PIPE) << 1; \
 	R15++; \
 	FETCHPIPE; \
@@ -3545,8 +3539,10 @@ static void fx_ramb (void)
 // df (ALT3) - romb - set current ROM bank
 static void fx_romb (void)
 {
+	FX_FLUSH_PLOT;
 	GSU.vRomBankReg = USEX8(SREG) & 0x7f;
 	GSU.pvRomBank = GSU.apvRomBank[GSU.vRomBankReg];
+	FX_PLOT_THROUGH;
 	CLRFLAGS;
 	R15++;
 }
@@ -3794,6 +3790,7 @@ static void fx_iwt_r15 (void)
 
 // f0-ff (ALT1) - lm rn, (xx) - load word from RAM
 #define FX_LM(reg) \
+	FX_FLUSH_PLOT; \
 	GSU.vLastRamAdr = PIPE; \
 	R15++; \
 	FETCHPIPE; \
@@ -3890,6 +3887,7 @@ static void fx_lm_r15 (void)
 // XXX: If rn == r15, is the value of r15 before or after the extra bytes are read ?
 #define FX_SM(reg) \
 	uint32	v = GSU.avReg[reg]; \
+	FX_FLUSH_PLOT; \
 	GSU.vLastRamAdr = PIPE; \
 	R15++; \
 	FETCHPIPE; \
@@ -3988,6 +3986,7 @@ uint32 fx_run (uint32 nInstructions)
 	GSU.vCounter = nInstructions;
 	while (TF(G) && (GSU.vCounter-- > 0))
 		FX_STEP;
+	FX_FLUSH_PLOT;
 #if 0
 #ifndef FX_ADDRESS_CHECK
 	GSU.vPipeAdr = USEX16(R15 - 1) | (USEX8(GSU.vPrgBankReg) << 16);
@@ -184,6 +184,11 @@ struct FxRegs_s
 	uint32	vScreenSize;
 	void	(*pfPlot) (void);
 	void	(*pfRpix) (void);
+	uint8	*pvPlotRow;					// Bitplane row the pixel row buffer belongs to
+	uint8	avPlotPixels[8];			// Buffered pixel colours, left to right
+	uint32	vPlotMask;					// Buffered pixels, 0x80 = leftmost
+	uint32	vPlotPlanes;				// Number of bitplanes in pvPlotRow
+	bool8	bPlotThrough;				// Code or R14 data is read from RAM, write pixels at once
 
 	uint8	*pvRamBank;					// Pointer to current RAM-bank
 	uint8	*pvRomBank;					// Pointer to current ROM-bank
@@ -280,6 +285,9 @@ extern struct FxRegs_s	GSU;
 // Read current RAM-Bank
 #define RAM(adr)		GSU.pvRamBank[USEX16(adr)]
 
+// Set GSU.bPlotThrough when code or R14 data comes from a RAM bank
+#define FX_PLOT_THROUGH	GSU.bPlotThrough = (GSU.vPrgBankReg & 0xfc) == 0x70 || (GSU.vRomBankReg & 0xfc) == 0x70
+
 // Read current ROM-Bank
 #define ROM(idx)		GSU.pvRomBank[USEX16(idx)]
 
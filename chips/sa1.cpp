@@ -606,6 +606,96 @@ void S9xSetSA1 (uint8 byte, uint32 address)
 		Memory.FillRAM[address] = byte;
 }
 
+// Character conversion works a row of 8 pixels at a time: the pixels are
+// spread one per byte (pixel k in byte k) and the resulting 8x8 bit matrix is
+// flipped about its anti-diagonal, which leaves bitplane n in byte 7 - n with
+// the leftmost pixel in its top bit.
+
+static inline uint64 SA1FlipAntiDiagonal (uint64 x)
+{
+	uint64	t;
+
+	t  = x ^ (x << 36);
+	x ^= 0xf0f0f0f00f0f0f0fULL & (t ^ (x >> 36));
+	t  = 0xcccc0000cccc0000ULL & (x ^ (x << 18));
+	x ^= t ^ (t >> 18);
+	t  = 0xaa00aa00aa00aa00ULL & (x ^ (x <<  9));
+	x ^= t ^ (t >>  9);
+
+	return (x);
+}
+
+static inline uint64 SA1LoadRow (const uint8 *q, int bytes)
+{
+	uint64	x = 0;
+
+	for (int i = 0; i < bytes; i++)
+		x |= (uint64) q[i] << (i * 8);
+
+	return (x);
+}
+
+static inline void SA1ConvertRow (uint8 *p, const uint8 *q, int depth, bool8 packed)
+{
+	uint64	x;
+
+	if (!packed) // bitmap registers: one pixel per byte
+		x = SA1LoadRow(q, 8) & (0x0101010101010101ULL * ((1 << depth) - 1));
+	else // packed bitmap: 8 / depth pixels per byte, lowest bits first
+	{
+		x = SA1LoadRow(q, depth);
+
+		switch (depth)
+		{
+			case 2:
+				x = (x | (x << 24)) & 0x000000ff000000ffULL;
+				x = (x | (x << 12)) & 0x000f000f000f000fULL;
+				x = (x | (x <<  6)) & 0x0303030303030303ULL;
+				break;
+
+			case 4:
+				x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+				x = (x | (x <<  8)) & 0x00ff00ff00ff00ffULL;
+				x = (x | (x <<  4)) & 0x0f0f0f0f0f0f0f0fULL;
+				break;
+		}
+	}
+
+	x = SA1FlipAntiDiagonal(x);
+
+	for (int n = 0; n < depth; n++)
+		p[(n >> 1) * 16 + (n & 1)] = (uint8) (x >> ((7 - n) * 8));
+}
+
+static inline void SA1ConvertChars (uint8 *p, const uint8 *line, int depth, uint32 bytes_per_line, uint32 chars)
+{
+	for (uint32 j = 0; j < chars; j++, line += depth, p += 8 * depth)
+	{
+		const uint8	*q = line;
+		for (int l = 0; l < 8; l++, q += bytes_per_line)
+			SA1ConvertRow(p + l * 2, q, depth, true);
+	}
+}
+
+void S9xSA1CharConv1 (uint8 *p, const uint8 *line, int depth, uint32 bytes_per_line, uint32 chars)
+{
+	// Literal depths let each case fold its gather and store loops
+	switch (depth)
+	{
+		case 2:
+			SA1ConvertChars(p, line, 2, bytes_per_line, chars);
+			break;
+
+		case 4:
+			SA1ConvertChars(p, line, 4, bytes_per_line, chars);
+			break;
+
+		case 8:
+			SA1ConvertChars(p, line, 8, bytes_per_line, chars);
+			break;
+	}
+}
+
 static void S9xSA1CharConv2 (void)
 {
 	uint32	dest           = Memory.FillRAM[0x2235] | (Memory.FillRAM[0x2236] << 8);
@@ -618,56 +708,18 @@ static void S9xSA1CharConv2 (void)
 	switch (depth)
 	{
 		case 2:
-			for (int l = 0; l < 8; l++, q += 8)
-			{
-				for (int b = 0; b < 8; b++)
-				{
-					uint8	r = *(q + b);
-					*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-					*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-				}
-
-				p += 2;
-			}
-
+			for (int l = 0; l < 8; l++, q += 8, p += 2)
+				SA1ConvertRow(p, q, 2, false);
 			break;
 
 		case 4:
-			for (int l = 0; l < 8; l++, q += 8)
-			{
-				for (int b = 0; b < 8; b++)
-				{
-					uint8	r = *(q + b);
-					*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-					*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-					*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-					*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-				}
-
-				p += 2;
-			}
-
+			for (int l = 0; l < 8; l++, q += 8, p += 2)
+				SA1ConvertRow(p, q, 4, false);
 			break;
 
 		case 8:
-			for (int l = 0; l < 8; l++, q += 8)
-			{
-				for (int b = 0; b < 8; b++)
-				{
-					uint8	r = *(q + b);
-					*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-					*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-					*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-					*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-					*(p + 32) = (*(p + 32) << 1) | ((r >> 4) & 1);
-					*(p + 33) = (*(p + 33) << 1) | ((r >> 5) & 1);
-					*(p + 48) = (*(p + 48) << 1) | ((r >> 6) & 1);
-					*(p + 49) = (*(p + 49) << 1) | ((r >> 7) & 1);
-				}
-
-				p += 2;
-			}
-
+			for (int l = 0; l < 8; l++, q += 8, p += 2)
+				SA1ConvertRow(p, q, 8, false);
 			break;
 	}
 }
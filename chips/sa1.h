@@ -94,6 +94,7 @@ void S9xSetSA1 (uint8, uint32);
 void S9xSA1Init (void);
 void S9xSA1MainLoop (void);
 void S9xSA1PostLoadState (void);
+void S9xSA1CharConv1 (uint8 *, const uint8 *, int, uint32, uint32);
 
 static inline void S9xSA1UnpackStatus (void)
 {
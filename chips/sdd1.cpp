@@ -4,9 +4,31 @@
    For further information, consult the LICENSE file in the root directory.
 \*****************************************************************************/
 
+#include <vector>
+
 #include "snes9x.h"
 #include "memmap.h"
 #include "sdd1.h"
+#include "sdd1emu.h"
+
+// Games DMA the same compressed ROM blocks over and over, so decompressed output
+// is kept per ROM offset. Output is a prefix of any longer decode from the same
+// offset, so an entry serves every transfer up to its length.
+#define SDD1_CACHE_ENTRIES	64
+#define SDD1_CACHE_BYTES	(2 * 1024 * 1024)
+
+static struct
+{
+	uint32				Offset;
+	uint32				LastUsed;
+	std::vector<uint8>	Data;
+}	SDD1Cache[SDD1_CACHE_ENTRIES];
+
+static uint32	SDD1CacheClock;
+static uint32	SDD1CacheBytes;
+static struct SSDD1CacheStats	SDD1Stats;
+
+static void S9xSDD1FlushCache (void);
 
 
 void S9xSetSDD1MemoryMap (uint32 bank, uint32 value)
@@ -22,8 +44,97 @@ void S9xSetSDD1MemoryMap (uint32 bank, uint32 value)
 	}
 }
 
+static void S9xSDD1FlushCache (void)
+{
+	for (int i = 0; i < SDD1_CACHE_ENTRIES; i++)
+	{
+		std::vector<uint8>().swap(SDD1Cache[i].Data);
+		SDD1Cache[i].LastUsed = 0;
+	}
+
+	SDD1CacheClock = 0;
+	SDD1CacheBytes = 0;
+}
+
+void S9xSDD1Decompress (uint8 *out, uint8 *in, int len)
+{
+	if (len == 0)
+		len = 0x10000;
+
+	// Only ROM is known not to change under us
+	if (in < Memory.ROM || in >= Memory.ROM + Memory.CalculatedSize)
+	{
+		SDD1_decompress(out, in, len);
+		SDD1Stats.Misses++;
+		SDD1Stats.BytesDecoded += len;
+		return;
+	}
+
+	uint32	offset = in - Memory.ROM;
+	int		slot = 0;
+
+	for (int i = 0; i < SDD1_CACHE_ENTRIES; i++)
+	{
+		if (SDD1Cache[i].Offset == offset && !SDD1Cache[i].Data.empty())
+		{
+			slot = i;
+			break;
+		}
+
+		if (SDD1Cache[i].LastUsed < SDD1Cache[slot].LastUsed)
+			slot = i;
+	}
+
+	std::vector<uint8>	&data = SDD1Cache[slot].Data;
+
+	if (SDD1Cache[slot].Offset == offset && data.size() >= (size_t) len)
+	{
+		memcpy(out, data.data(), len);
+		SDD1Cache[slot].LastUsed = ++SDD1CacheClock;
+		SDD1Stats.Hits++;
+		return;
+	}
+
+	SDD1_decompress(out, in, len);
+	SDD1Stats.Misses++;
+	SDD1Stats.BytesDecoded += len;
+
+	// Replace the entry (or grow it), then drop least recently used ones over the cap
+	SDD1CacheBytes -= data.size();
+	data.assign(out, out + len);
+	SDD1CacheBytes += len;
+	SDD1Cache[slot].Offset = offset;
+	SDD1Cache[slot].LastUsed = ++SDD1CacheClock;
+
+	while (SDD1CacheBytes > SDD1_CACHE_BYTES)
+	{
+		int	oldest = -1;
+
+		for (int i = 0; i < SDD1_CACHE_ENTRIES; i++)
+		{
+			if (i != slot && !SDD1Cache[i].Data.empty() && (oldest < 0 || SDD1Cache[i].LastUsed < SDD1Cache[oldest].LastUsed))
+				oldest = i;
+		}
+
+		if (oldest < 0)
+			break;
+
+		SDD1CacheBytes -= SDD1Cache[oldest].Data.size();
+		std::vector<uint8>().swap(SDD1Cache[oldest].Data);
+		SDD1Cache[oldest].LastUsed = 0;
+	}
+}
+
+void S9xSDD1GetCacheStats (struct SSDD1CacheStats *stats)
+{
+	*stats = SDD1Stats;
+}
+
 void S9xResetSDD1 (void)
 {
+	// A reset may come with a different ROM
+	S9xSDD1FlushCache();
+
 	memset(&Memory.FillRAM[0x4800], 0, 4);
 	for (int i = 0; i < 4; i++)
 	{
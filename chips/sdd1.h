@@ -7,7 +7,16 @@
 #ifndef SNES9X_SDD1_H_
 #define SNES9X_SDD1_H_
 
+struct SSDD1CacheStats
+{
+	uint32	Hits;			// DMA transfers served from decompressed blocks
+	uint32	Misses;
+	uint64	BytesDecoded;	// bytes run through the decompressor
+};
+
 void S9xSetSDD1MemoryMap (uint32, uint32);
+void S9xSDD1Decompress (uint8 *, uint8 *, int);
+void S9xSDD1GetCacheStats (struct SSDD1CacheStats *);
 void S9xResetSDD1 (void);
 void S9xSDD1PostLoadState (void);
 
@@ -27,6 +27,7 @@
 #include "snes9x.h"
 #include "memmap.h"
 #include "srtc.h"
+#include "snapshot.h"
 
 #define memory_cartrom_size()		Memory.CalculatedSize
 #define memory_cartrom_read(a)		Memory.ROM[(a)]
@@ -226,6 +227,23 @@ void S9xSPC7110PreSaveState (void)
 		s7snap.context[i].index  = s7emu.decomp.context[i].index;
 		s7snap.context[i].invert = s7emu.decomp.context[i].invert;
 	}
+
+	for (int i = 0; i < 16; i++)
+	{
+		s7snap.decoder.pixelorder[i]     = (uint32) s7emu.decomp.state.pixelorder[i];
+		s7snap.decoder.bitplanebuffer[i] = s7emu.decomp.state.bitplanebuffer[i];
+	}
+
+	s7snap.decoder.buffer_index = s7emu.decomp.state.buffer_index;
+	s7snap.decoder.in           = s7emu.decomp.state.in;
+	s7snap.decoder.val          = s7emu.decomp.state.val;
+	s7snap.decoder.span         = s7emu.decomp.state.span;
+	s7snap.decoder.out          = (int32) s7emu.decomp.state.out;
+	s7snap.decoder.out0         = (int32) s7emu.decomp.state.out0;
+	s7snap.decoder.out1         = (int32) s7emu.decomp.state.out1;
+	s7snap.decoder.inverts      = (int32) s7emu.decomp.state.inverts;
+	s7snap.decoder.lps          = (int32) s7emu.decomp.state.lps;
+	s7snap.decoder.in_count     = (int32) s7emu.decomp.state.in_count;
 }
 
 void S9xSPC7110PostLoadState (int version)
@@ -308,5 +326,30 @@ void S9xSPC7110PostLoadState (int version)
 		s7emu.decomp.context[i].invert = s7snap.context[i].invert;
 	}
 
+	// Older snapshots don't have the decoder state; leave the current one alone as before
+	if (version >= SNAPSHOT_VERSION_SPC7110_DECODER)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			s7emu.decomp.state.pixelorder[i]     = (unsigned) s7snap.decoder.pixelorder[i];
+			s7emu.decomp.state.bitplanebuffer[i] = s7snap.decoder.bitplanebuffer[i];
+		}
+
+		s7emu.decomp.state.buffer_index = s7snap.decoder.buffer_index;
+		s7emu.decomp.state.in           = s7snap.decoder.in;
+		s7emu.decomp.state.val          = s7snap.decoder.val;
+		s7emu.decomp.state.span         = s7snap.decoder.span;
+		s7emu.decomp.state.out          = (int) s7snap.decoder.out;
+		s7emu.decomp.state.out0         = (int) s7snap.decoder.out0;
+		s7emu.decomp.state.out1         = (int) s7snap.decoder.out1;
+		s7emu.decomp.state.inverts      = (int) s7snap.decoder.inverts;
+		s7emu.decomp.state.lps          = (int) s7snap.decoder.lps;
+		s7emu.decomp.state.in_count     = (int) s7snap.decoder.in_count;
+	}
+
+	// The position within the stream isn't saved, so stop taking checkpoints until the next seek
+	s7emu.decomp.current_stream  = -1;
+	s7emu.decomp.next_checkpoint = 0;
+
 	s7emu.update_time(0);
 }
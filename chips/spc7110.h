@@ -88,6 +88,22 @@ struct SSPC7110Snapshot
 		uint8	index;
 		uint8	invert;
 	}	context[32];
+
+	struct
+	{
+		uint32	pixelorder[16];
+		uint8	bitplanebuffer[16];
+		uint8	buffer_index;
+		uint8	in;
+		uint8	val;
+		uint8	span;
+		int32	out;
+		int32	out0;
+		int32	out1;
+		int32	inverts;
+		int32	lps;
+		int32	in_count;
+	}	decoder;
 };
 
 extern struct SSPC7110Snapshot	s7snap;
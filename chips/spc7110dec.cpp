@@ -32,6 +32,21 @@ uint8 SPC7110Decomp::read() {
   uint8 data = decomp_buffer[decomp_buffer_rdoffset++];
   decomp_buffer_rdoffset &= decomp_buffer_size - 1;
   decomp_buffer_length--;
+
+  if(++output_index == next_checkpoint && next_checkpoint) {
+    //first time this far into the stream; remember how to get back here
+    if(checkpoint_count >= cache_checkpoints) evict_streams();
+    if(checkpoint_count < cache_checkpoints) {
+      Stream &stream = streams[current_stream];
+      stream.checkpoints.push_back(Checkpoint());
+      save_checkpoint(stream.checkpoints.back());
+      checkpoint_count++;
+      next_checkpoint += checkpoint_interval;
+    } else {
+      next_checkpoint = 0;
+    }
+  }
+
   return data;
 }
 
@@ -55,6 +70,10 @@ void SPC7110Decomp::init(unsigned mode, unsigned offset, unsigned index) {
   decomp_buffer_wroffset = 0;
   decomp_buffer_length   = 0;
 
+  current_stream  = -1;
+  output_index    = 0;
+  next_checkpoint = 0;
+
   //reset context states
   for(unsigned i = 0; i < 32; i++) {
     context[i].index  = 0;
@@ -65,17 +84,98 @@ void SPC7110Decomp::init(unsigned mode, unsigned offset, unsigned index) {
     case 0: mode0(true); break;
     case 1: mode1(true); break;
     case 2: mode2(true); break;
+    default: return; //invalid mode always reads 0x00
   }
 
+  //resume from the closest checkpoint at or before the requested index
+  current_stream = find_stream(mode, offset);
+  Stream &stream = streams[current_stream];
+  stream.last_used = ++stream_clock;
+
+  unsigned n = index / checkpoint_interval;
+  if(n >= stream.checkpoints.size()) n = stream.checkpoints.size() - 1;
+  load_checkpoint(stream.checkpoints[n]);
+  output_index    = n * checkpoint_interval;
+  next_checkpoint = stream.checkpoints.size() * checkpoint_interval;
+
   //decompress up to requested output data index
-  while(index--) read();
+  while(output_index < index) read();
+}
+
+int SPC7110Decomp::find_stream(unsigned mode, unsigned offset) {
+  int slot = -1;
+  for(unsigned i = 0; i < streams.size(); i++) {
+    if(streams[i].checkpoints.size() && streams[i].mode == mode && streams[i].offset == offset) return i;
+    if(slot < 0 || streams[i].last_used < streams[slot].last_used) slot = i;
+  }
+
+  if(streams.size() < cache_streams) {
+    streams.push_back(Stream());
+    slot = streams.size() - 1;
+  }
+
+  //new stream starts with the freshly initialized decoder
+  Stream &stream = streams[slot];
+  checkpoint_count -= stream.checkpoints.size();
+  stream.checkpoints.clear();
+  stream.mode = mode;
+  stream.offset = offset;
+  stream.last_used = 0;
+  stream.checkpoints.push_back(Checkpoint());
+  save_checkpoint(stream.checkpoints.back());
+  checkpoint_count++;
+  return slot;
+}
+
+void SPC7110Decomp::evict_streams() {
+  //drop least recently used streams (other than the one being read) until under the cap
+  while(checkpoint_count >= cache_checkpoints) {
+    int slot = -1;
+    for(unsigned i = 0; i < streams.size(); i++) {
+      if((int)i == current_stream || streams[i].checkpoints.empty()) continue;
+      if(slot < 0 || streams[i].last_used < streams[slot].last_used) slot = i;
+    }
+    if(slot < 0) return;
+
+    checkpoint_count -= streams[slot].checkpoints.size();
+    std::vector<Checkpoint>().swap(streams[slot].checkpoints);
+    streams[slot].last_used = 0;
+  }
+}
+
+void SPC7110Decomp::save_checkpoint(Checkpoint &cp) const {
+  cp.state = state;
+  memcpy(cp.context, context, sizeof(context));
+  cp.offset = decomp_offset;
+  memcpy(cp.buffer, decomp_buffer, decomp_buffer_size);
+  cp.rdoffset = decomp_buffer_rdoffset;
+  cp.wroffset = decomp_buffer_wroffset;
+  cp.length   = decomp_buffer_length;
+}
+
+void SPC7110Decomp::load_checkpoint(const Checkpoint &cp) {
+  state = cp.state;
+  memcpy(context, cp.context, sizeof(context));
+  decomp_offset = cp.offset;
+  memcpy(decomp_buffer, cp.buffer, decomp_buffer_size);
+  decomp_buffer_rdoffset = cp.rdoffset;
+  decomp_buffer_wroffset = cp.wroffset;
+  decomp_buffer_length   = cp.length;
+}
+
+void SPC7110Decomp::flush_cache() {
+  streams.clear();
+  checkpoint_count = 0;
+  current_stream   = -1;
+  output_index     = 0;
+  next_checkpoint  = 0;
 }
 
 //
 
 void SPC7110Decomp::mode0(bool init) {
-  static uint8 val, in, span;
-  static int out, inverts, lps, in_count;
+  uint8 &val = state.val, &in = state.in, &span = state.span;
+  int &out = state.out, &inverts = state.inverts, &lps = state.lps, &in_count = state.in_count;
 
   if(init == true) {
     out = inverts = lps = 0;
@@ -141,9 +241,9 @@ void SPC7110Decomp::mode0(bool init) {
 }
 
 void SPC7110Decomp::mode1(bool init) {
-  static unsigned pixelorder[4], realorder[4];
-  static uint8 in, val, span;
-  static int out, inverts, lps, in_count;
+  unsigned *pixelorder = state.pixelorder, realorder[4];
+  uint8 &in = state.in, &val = state.val, &span = state.span;
+  int &out = state.out, &inverts = state.inverts, &lps = state.lps, &in_count = state.in_count;
 
   if(init == true) {
     for(unsigned i = 0; i < 4; i++) pixelorder[i] = i;
@@ -244,10 +344,10 @@ void SPC7110Decomp::mode1(bool init) {
 }
 
 void SPC7110Decomp::mode2(bool init) {
-  static unsigned pixelorder[16], realorder[16];
-  static uint8 bitplanebuffer[16], buffer_index;
-  static uint8 in, val, span;
-  static int out0, out1, inverts, lps, in_count;
+  unsigned *pixelorder = state.pixelorder, realorder[16];
+  uint8 *bitplanebuffer = state.bitplanebuffer, &buffer_index = state.buffer_index;
+  uint8 &in = state.in, &val = state.val, &span = state.span;
+  int &out0 = state.out0, &out1 = state.out1, &inverts = state.inverts, &lps = state.lps, &in_count = state.in_count;
 
   if(init == true) {
     for(unsigned i = 0; i < 16; i++) pixelorder[i] = i;
@@ -495,10 +595,15 @@ void SPC7110Decomp::reset() {
   decomp_buffer_rdoffset = 0;
   decomp_buffer_wroffset = 0;
   decomp_buffer_length   = 0;
+
+  //a reset may come with a different ROM
+  flush_cache();
 }
 
 SPC7110Decomp::SPC7110Decomp() {
   decomp_buffer = new uint8[decomp_buffer_size];
+  memset(&state, 0, sizeof(state));
+  stream_clock = 0;
   reset();
 
   //initialize reverse morton lookup tables
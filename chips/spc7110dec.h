@@ -19,6 +19,8 @@
 #ifndef SNES9X_SPC7110DEC_H_
 #define SNES9X_SPC7110DEC_H_
 
+#include <vector>
+
 class SPC7110Decomp {
 public:
   uint8 read();
@@ -45,14 +47,60 @@ public:
   void mode1(bool init);
   void mode2(bool init);
 
-  static const uint8 evolution_table[53][4];
-  static const uint8 mode2_context_table[32][2];
+  //decoder state of the active mode (mode0 uses out; mode2 uses out0/out1 and the bitplane buffer)
+  struct DecoderState {
+    unsigned pixelorder[16];
+    uint8 bitplanebuffer[16];
+    uint8 buffer_index;
+    uint8 in, val, span;
+    int out, out0, out1, inverts, lps, in_count;
+  } state;
+
+  //seek cache: streams are deterministic in (mode, offset), so decoder checkpoints taken
+  //every checkpoint_interval output bytes let init() resume near the requested index
+  //instead of decompressing everything before it
+  enum { checkpoint_interval = 256 };
+  enum { cache_streams = 32 };
+  enum { cache_checkpoints = 4096 }; //~1MB over all streams
 
   struct ContextState {
     uint8 index;
     uint8 invert;
   } context[32];
 
+  struct Checkpoint {
+    DecoderState state;
+    ContextState context[32];
+    unsigned offset;
+    uint8 buffer[decomp_buffer_size];
+    unsigned rdoffset;
+    unsigned wroffset;
+    unsigned length;
+  };
+
+  struct Stream {
+    unsigned mode;
+    unsigned offset;
+    unsigned last_used;
+    std::vector<Checkpoint> checkpoints; //checkpoints[n] is at output index n * checkpoint_interval
+  };
+
+  std::vector<Stream> streams;
+  unsigned stream_clock;
+  int current_stream;         //stream being read from, -1 if not tracked
+  unsigned output_index;      //bytes read from current stream
+  unsigned next_checkpoint;   //output index at which to take the next checkpoint, 0 if none
+  unsigned checkpoint_count;
+
+  int find_stream(unsigned mode, unsigned offset);
+  void evict_streams();
+  void save_checkpoint(Checkpoint &cp) const;
+  void load_checkpoint(const Checkpoint &cp);
+  void flush_cache();
+
+  static const uint8 evolution_table[53][4];
+  static const uint8 mode2_context_table[32][2];
+
   uint8 probability(unsigned n);
   uint8 next_lps(unsigned n);
   uint8 next_mps(unsigned n);
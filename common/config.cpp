@@ -82,6 +82,18 @@ static void apply_setting(const std::string &section,
             config.save_dir = value;
         else if (key == "rewind_enabled" && parse_bool(value, bval))
             config.rewind_enabled = bval;
+        else if (key == "fast_dsp" && parse_bool(value, bval))
+            config.fast_dsp = bval;
+        else if (key == "deferred_render" && parse_bool(value, bval))
+            config.deferred_render = bval;
+        else if (key == "native_line_width" && parse_bool(value, bval))
+            config.native_line_width = bval;
+        else if (key == "idle_loop_skip" && parse_bool(value, bval))
+            config.idle_loop_skip = bval;
+        else if (key == "audio_clock" && parse_bool(value, bval))
+            config.audio_clock = bval;
+        else if (key == "record_input" && parse_bool(value, bval))
+            config.record_input = bval;
     }
     else if (section == "keyboard")
     {
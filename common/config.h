@@ -25,6 +25,12 @@ struct S9xConfig {
     std::string rom_path;
     std::string save_dir;
     bool rewind_enabled = true;
+    bool fast_dsp = false;     // Whole-sample DSP instead of the cycle-accurate pipeline
+    bool deferred_render = false; // Render each frame in one pass at end of frame
+    bool native_line_width = false; // Leave 256-pixel lines of hires frames undoubled (frontend scales)
+    bool idle_loop_skip = true;   // Fast-forward the CPU and SPC700 through idle loops and WAI
+    bool audio_clock = false;     // Pace emulation from the audio queue instead of the display (Android)
+    bool record_input = false;    // Keep an input log of each session for exact replay (<rom>.inputlog)
     S9xKeyboardMapping keyboard;
     std::vector<S9xControllerMapping> controllers;
 };
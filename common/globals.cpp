@@ -14,6 +14,7 @@
 
 struct SCPUState		CPU;
 struct SICPU			ICPU;
+struct SIdleLoop		IdleLoop;
 struct SRegisters		Registers;
 struct SPPU				PPU;
 struct InternalPPU		IPPU;
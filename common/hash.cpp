@@ -0,0 +1,100 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#include <cstring>
+#include "hash.h"
+
+static const uint64_t	PRIME1 = 0x9e3779b185ebca87ull;
+static const uint64_t	PRIME2 = 0xc2b2ae3d27d4eb4full;
+static const uint64_t	PRIME3 = 0x165667b19e3779f9ull;
+static const uint64_t	PRIME4 = 0x85ebca77c2b2ae63ull;
+static const uint64_t	PRIME5 = 0x27d4eb2f165667c5ull;
+
+static inline uint64_t Rotl (uint64_t v, int n)
+{
+	return ((v << n) | (v >> (64 - n)));
+}
+
+static inline uint64_t Read64 (const uint8_t *p)
+{
+	uint64_t	v;
+	memcpy(&v, p, 8);
+	return (v);
+}
+
+static inline uint32_t Read32 (const uint8_t *p)
+{
+	uint32_t	v;
+	memcpy(&v, p, 4);
+	return (v);
+}
+
+static inline uint64_t Round (uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME2;
+	return (Rotl(acc, 31) * PRIME1);
+}
+
+static inline uint64_t Merge (uint64_t h, uint64_t acc)
+{
+	h ^= Round(0, acc);
+	return (h * PRIME1 + PRIME4);
+}
+
+uint64_t S9xHash64 (const void *data, size_t size, uint64_t seed)
+{
+	const uint8_t	*p   = (const uint8_t *) data;
+	const uint8_t	*end = p + size;
+	uint64_t		h;
+
+	// Four independent lanes over 32-byte stripes
+	if (size >= 32)
+	{
+		uint64_t	v1 = seed + PRIME1 + PRIME2;
+		uint64_t	v2 = seed + PRIME2;
+		uint64_t	v3 = seed;
+		uint64_t	v4 = seed - PRIME1;
+
+		for (; p + 32 <= end; p += 32)
+		{
+			v1 = Round(v1, Read64(p));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+		}
+
+		h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+		h = Merge(h, v1);
+		h = Merge(h, v2);
+		h = Merge(h, v3);
+		h = Merge(h, v4);
+	}
+	else
+		h = seed + PRIME5;
+
+	h += size;
+
+	for (; p + 8 <= end; p += 8)
+		h = Rotl(h ^ Round(0, Read64(p)), 27) * PRIME1 + PRIME4;
+
+	if (p + 4 <= end)
+	{
+		h = Rotl(h ^ (Read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+
+	for (; p < end; p++)
+		h = Rotl(h ^ (*p * PRIME5), 11) * PRIME1;
+
+	// Final avalanche
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+
+	return (h);
+}
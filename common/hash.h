@@ -0,0 +1,20 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef SNES9X_HASH_H_
+#define SNES9X_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit non-cryptographic hash (the xxHash64 algorithm), for telling whether
+// a block of memory changed. Every input bit reaches every output bit, so
+// unlike a word-wise FNV no two changes cancel out. Pass the previous result
+// as the seed to hash several blocks as one.
+
+uint64_t S9xHash64 (const void *, size_t, uint64_t seed = 0);
+
+#endif
@@ -0,0 +1,187 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#include <cstring>
+#include "lz.h"
+
+// Each sequence is a token (literal count << 4 | match length - 4), the
+// literal count's 255-byte extension, the literals, a 16-bit offset and the
+// match length's extension. The last sequence has literals only. As in LZ4,
+// the final 5 bytes are always literals and no match starts in the last 12.
+
+enum
+{
+	HASH_BITS		= 14,
+	MIN_MATCH		= 4,
+	LAST_LITERALS	= 5,
+	MATCH_LIMIT		= 12,
+	MAX_OFFSET		= 65535,
+	HEADER_SIZE		= LZ_MAGIC_LEN + 4
+};
+
+static inline uint32_t Read32 (const uint8_t *p)
+{
+	uint32_t	v;
+	memcpy(&v, p, 4);
+	return (v);
+}
+
+static inline uint32_t Hash (uint32_t v)
+{
+	return ((v * 2654435761u) >> (32 - HASH_BITS));
+}
+
+static inline uint8_t * PutLength (uint8_t *op, size_t len)
+{
+	for (; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = (uint8_t) len;
+	return (op);
+}
+
+static inline uint8_t * PutSequence (uint8_t *op, const uint8_t *literals, size_t litlen, size_t offset, size_t matchlen)
+{
+	uint8_t	*token = op++;
+	size_t	m = matchlen ? matchlen - MIN_MATCH : 0;
+
+	*token = (uint8_t) ((litlen < 15 ? litlen : 15) << 4 | (m < 15 ? m : 15));
+	if (litlen >= 15)
+		op = PutLength(op, litlen - 15);
+	memcpy(op, literals, litlen);
+	op += litlen;
+
+	if (matchlen)
+	{
+		*op++ = (uint8_t) offset;
+		*op++ = (uint8_t) (offset >> 8);
+		if (m >= 15)
+			op = PutLength(op, m - 15);
+	}
+
+	return (op);
+}
+
+bool S9xIsPackedLZ (const uint8_t *src, size_t size)
+{
+	return (size >= HEADER_SIZE && memcmp(src, LZ_MAGIC, LZ_MAGIC_LEN) == 0);
+}
+
+void S9xPackLZ (const uint8_t *src, size_t size, std::vector<uint8_t> &out)
+{
+	// Incompressible input grows by one length byte per 255 literals.
+	out.resize(HEADER_SIZE + size + size / 255 + 16);
+
+	uint8_t	*op = out.data();
+	memcpy(op, LZ_MAGIC, LZ_MAGIC_LEN);
+	for (int i = 0; i < 4; i++)
+		op[LZ_MAGIC_LEN + i] = (uint8_t) (size >> (i * 8));
+	op += HEADER_SIZE;
+
+	std::vector<uint32_t>	table(1 << HASH_BITS, 0);
+	size_t	ip = 0, anchor = 0;
+
+	if (size > MATCH_LIMIT)
+	{
+		const size_t	limit = size - MATCH_LIMIT;
+
+		while (ip < limit)
+		{
+			uint32_t	seq = Read32(src + ip);
+			uint32_t	&slot = table[Hash(seq)];
+			size_t		cand = slot;
+
+			slot = (uint32_t) ip;
+
+			if (cand >= ip || ip - cand > MAX_OFFSET || Read32(src + cand) != seq)
+			{
+				// Skip faster through data that isn't matching.
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			size_t	len = MIN_MATCH;
+			while (ip + len < size - LAST_LITERALS && src[cand + len] == src[ip + len])
+				len++;
+
+			op = PutSequence(op, src + anchor, ip - anchor, ip - cand, len);
+			ip += len;
+			anchor = ip;
+		}
+	}
+
+	op = PutSequence(op, src + anchor, size - anchor, 0, 0);
+	out.resize(op - out.data());
+}
+
+bool S9xUnpackLZ (const uint8_t *src, size_t size, std::vector<uint8_t> &out)
+{
+	if (!S9xIsPackedLZ(src, size))
+		return (false);
+
+	size_t	outsize = 0;
+	for (int i = 0; i < 4; i++)
+		outsize |= (size_t) src[LZ_MAGIC_LEN + i] << (i * 8);
+	out.resize(outsize);
+
+	const uint8_t	*ip = src + HEADER_SIZE, *iend = src + size;
+	uint8_t			*op = out.data(), *oend = op + outsize;
+
+	while (ip < iend)
+	{
+		uint8_t	token = *ip++;
+		size_t	litlen = token >> 4;
+
+		if (litlen == 15)
+		{
+			uint8_t	b;
+			do
+			{
+				if (ip >= iend)
+					return (false);
+				litlen += b = *ip++;
+			} while (b == 255);
+		}
+
+		if (litlen > (size_t) (iend - ip) || litlen > (size_t) (oend - op))
+			return (false);
+		memcpy(op, ip, litlen);
+		ip += litlen;
+		op += litlen;
+
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return (false);
+		size_t	offset = ip[0] | ip[1] << 8;
+		ip += 2;
+		if (offset == 0 || offset > (size_t) (op - out.data()))
+			return (false);
+
+		size_t	matchlen = (token & 15) + MIN_MATCH;
+		if ((token & 15) == 15)
+		{
+			uint8_t	b;
+			do
+			{
+				if (ip >= iend)
+					return (false);
+				matchlen += b = *ip++;
+			} while (b == 255);
+		}
+
+		if (matchlen > (size_t) (oend - op))
+			return (false);
+
+		// Byte copy: the match may overlap the bytes it produces.
+		const uint8_t	*match = op - offset;
+		for (size_t i = 0; i < matchlen; i++)
+			op[i] = match[i];
+		op += matchlen;
+	}
+
+	return (op == oend);
+}
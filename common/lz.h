@@ -0,0 +1,25 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef SNES9X_LZ_H_
+#define SNES9X_LZ_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Small LZ77 codec using the LZ4 block layout, for save states written in
+// the background. A packed buffer starts with LZ_MAGIC and the unpacked size
+// (32-bit little endian), so readers can tell it from a plain snapshot.
+
+#define LZ_MAGIC		"#!s9xlz4"
+#define LZ_MAGIC_LEN	8
+
+bool S9xIsPackedLZ (const uint8_t *, size_t);
+void S9xPackLZ (const uint8_t *, size_t, std::vector<uint8_t> &);
+bool S9xUnpackLZ (const uint8_t *, size_t, std::vector<uint8_t> &);
+
+#endif
@@ -37,6 +37,9 @@ static struct
 	uint16	buttons;
 }	joypad[8];
 
+static void			(*poll_callback) (void *) = NULL;
+static void			*poll_data = NULL;
+
 static bool8		FLAG_LATCH = false;
 static int32		curcontrollers[2] = { NONE, NONE };
 static int32		newcontrollers[2] = { JOYPAD0, NONE };
@@ -180,6 +183,10 @@ uint8 S9xReadJOYSERn (int n)
 
 	uint8	bits = (OpenBus & ~3) | ((n == 1) ? 0x1c : 0);
 
+	// Poll once per 16-bit read, so the bits all come from one sample
+	if (poll_callback && (FLAG_LATCH || read_idx[n][0] == 0))
+		poll_callback(poll_data);
+
 	if (FLAG_LATCH)
 	{
 		switch (i = curcontrollers[n])
@@ -231,6 +238,9 @@ uint8 S9xReadJOYSERn (int n)
 // serial read index as fully consumed (16).
 void S9xDoAutoJoypad (void)
 {
+	if (poll_callback)
+		poll_callback(poll_data);
+
 	S9xSetJoypadLatch(1);
 	S9xSetJoypadLatch(0);
 
@@ -331,6 +341,13 @@ void S9xControlPostLoadState (struct SControlSnapshot *s)
 	}
 }
 
+// Register the frontend's input poll, see controls.h.
+void S9xSetJoypadPollCallback (void (*callback) (void *), void *data)
+{
+	poll_callback = callback;
+	poll_data     = data;
+}
+
 // Set the button state for a joypad slot (0-7) directly.
 // This is the primary input entry point for frontends — call once per frame
 // with a bitmask of SNES_*_MASK values from snes9x.h.
@@ -341,3 +358,11 @@ void S9xSetJoypadButtons (int pad, uint16 buttons)
 
 	joypad[pad].buttons = buttons;
 }
+
+uint16 S9xGetJoypadButtons (int pad)
+{
+	if (pad < 0 || pad > 7)
+		return (0);
+
+	return (joypad[pad].buttons);
+}
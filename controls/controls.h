@@ -34,6 +34,17 @@ bool S9xVerifyControllers (void);
 // pad: 0-7, buttons: SNES_*_MASK bitmask from snes9x.h
 void S9xSetJoypadButtons (int pad, uint16 buttons);
 
+// Current button state of a joypad slot (0-7), as the game will read it
+// Called by: mem/inputlog.cpp
+uint16 S9xGetJoypadButtons (int pad);
+
+// Register a function to call right before the core samples the joypads, so
+// the frontend can call S9xSetJoypadButtons with the freshest input: at
+// auto-joypad read time, and on $4016/$4017 reads of the first bit after a
+// latch (or of every bit while the latch is held). NULL unregisters it.
+// Called by: platform/shared/emulator.cpp
+void S9xSetJoypadPollCallback (void (*callback) (void *), void *data);
+
 //////////
 // Core emulator callbacks (called by PPU/CPU/etc)
 //////////
@@ -53,6 +53,7 @@ static void S9xSoftResetCPU (void)
 	CPU.MemSpeed = SLOW_ONE_CYCLE;
 	CPU.MemSpeedx2 = SLOW_ONE_CYCLE * 2;
 	CPU.FastROMSpeed = SLOW_ONE_CYCLE;
+	Memory.map_FastROMSpeed();
 	CPU.InDMA = false;
 	CPU.InHDMA = false;
 	CPU.InDMAorHDMA = false;
@@ -63,6 +64,8 @@ static void S9xSoftResetCPU (void)
 	CPU.NextEvent  = Timings.RenderPos;
 	CPU.WaitingForInterrupt = false;
 	CPU.AutoSaveTimer = 0;
+	IdleLoop.Branch = 0;
+	IdleLoop.Unsafe = 0;
 	CPU.SRAMModified = false;
 
 	Registers.PBPC = 0;
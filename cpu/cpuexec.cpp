@@ -60,6 +60,7 @@ void S9xMainLoop (void)
 				}
 
 				CHECK_FOR_IRQ_CHANGE();
+				IdleLoop.Branch = 0;
 				S9xOpcode_NMI();
 			}
 		}
@@ -72,6 +73,7 @@ void S9xMainLoop (void)
 
 			S9xUpdateIRQPositions(false);
 			CPU.IRQLine = true;
+			IdleLoop.Branch = 0;
 		}
 
 		if (CPU.IRQLine || CPU.IRQExternal)
@@ -89,6 +91,7 @@ void S9xMainLoop (void)
 			{
 				/* The flag pushed onto the stack is the new value */
 				CHECK_FOR_IRQ_CHANGE();
+				IdleLoop.Branch = 0;
 				S9xOpcode_IRQ();
 			}
 		}
@@ -231,6 +234,9 @@ void S9xDoHEventProcessing (void)
 			eventname[CPU.WhichEvent], CPU.NextEvent, CPU.Cycles, CPU.V_Counter);
 #endif
 
+	// Whatever a loop was waiting for may happen here
+	IdleLoop.Branch = 0;
+
 	switch (CPU.WhichEvent)
 	{
 		case HC_HBLANK_START_EVENT:
@@ -425,3 +431,237 @@ void S9xDoHEventProcessing (void)
 			eventname[CPU.WhichEvent], CPU.NextEvent, CPU.Cycles);
 #endif
 }
+
+// Idle loops
+
+// True if reading Address can't change anything and returns the same value
+// until the next H-event. *HVBJOY is set when it's $4212, whose H-blank bit
+// also flips at Timings.HBlankEnd.
+static bool8 S9xIdleLoopStableRead (uint32 Address, bool8 *HVBJOY)
+{
+	uint8	*p = Memory.Map[(Address & 0xffffff) >> MEMMAP_SHIFT];
+
+	if ((Address & 0xffff) == 0xffff)
+		return (false);
+
+	if (p >= (uint8 *) CMemory::MAP_LAST)
+		return (true);
+
+	switch ((pint) p)
+	{
+		case CMemory::MAP_LOROM_SRAM:
+		case CMemory::MAP_LOROM_SRAM_B:
+		case CMemory::MAP_HIROM_SRAM:
+		case CMemory::MAP_RONLY_SRAM:
+			return (true);
+
+		case CMemory::MAP_CPU:
+			// RDNMI, TIMEUP, HVBJOY, RDIO and the multiply/divide results.
+			// Only the first read of RDNMI/TIMEUP clears anything, and the
+			// flags they report are raised at events or by the IRQ timer.
+			Address &= 0xffff;
+			if (Address < 0x4210 || Address > 0x4217)
+				return (false);
+			if (Address == 0x4212)
+				*HVBJOY = true;
+			return (true);
+
+		default:
+			return (false);
+	}
+}
+
+// Checks the instructions from Target up to the branch at End - 2. They may
+// only read stable memory and change registers and flags, so that running
+// them again from the same state gives the same state. Returns -1 if the body
+// can never qualify, 0 if it doesn't with the current registers.
+static int S9xIdleLoopBody (uint16 Target, uint16 End, bool8 *HVBJOY)
+{
+	uint16	pc = Target;
+
+	if ((Target & ~MEMMAP_MASK) != (End & ~MEMMAP_MASK))
+		return (-1);
+
+	while (pc != (uint16) (End - 2))
+	{
+		uint8	op = CPU.PCBase[pc];
+		uint8	len = ICPU.S9xOpLengths[op];
+		uint16	operand = CPU.PCBase[(uint16) (pc + 1)];
+		uint32	ea = 0;
+		bool8	read = true;
+
+		if (len >= 3)
+			operand |= CPU.PCBase[(uint16) (pc + 2)] << 8;
+
+		switch (op)
+		{
+			case 0xea: case 0x18: case 0x38: case 0xb8:		// NOP CLC SEC CLV
+			case 0xaa: case 0xa8: case 0x8a: case 0x98:		// TAX TAY TXA TYA
+			case 0x9b: case 0xbb: case 0xeb:				// TXY TYX XBA
+			case 0xa9: case 0xa2: case 0xa0: case 0xc9:		// #imm
+			case 0xe0: case 0xc0: case 0x89: case 0x29:
+			case 0x09: case 0x49:
+				read = false;
+				break;
+
+			case 0xa5: case 0xa6: case 0xa4: case 0xc5:		// dp
+			case 0xe4: case 0xc4: case 0x24: case 0x25:
+			case 0x05: case 0x45:
+				ea = (uint16) (Registers.D.W + operand);
+				break;
+
+			case 0xb5: case 0xb4: case 0xd5: case 0x34:		// dp,X
+			case 0x35: case 0x15: case 0x55:
+				ea = (uint16) (Registers.D.W + operand + Registers.X.W);
+				break;
+
+			case 0xb6:										// dp,Y
+				ea = (uint16) (Registers.D.W + operand + Registers.Y.W);
+				break;
+
+			case 0xad: case 0xae: case 0xac: case 0xcd:		// abs
+			case 0xec: case 0xcc: case 0x2c: case 0x2d:
+			case 0x0d: case 0x4d:
+				ea = ICPU.ShiftedDB + operand;
+				break;
+
+			case 0xbd: case 0xbc: case 0xdd: case 0x3c:		// abs,X
+			case 0x3d: case 0x1d: case 0x5d:
+				ea = ICPU.ShiftedDB + operand + Registers.X.W;
+				break;
+
+			case 0xb9: case 0xbe: case 0xd9: case 0x39:		// abs,Y
+			case 0x19: case 0x59:
+				ea = ICPU.ShiftedDB + operand + Registers.Y.W;
+				break;
+
+			case 0xaf: case 0xcf: case 0x2f: case 0x0f:		// long
+			case 0x4f:
+				ea = operand | (CPU.PCBase[(uint16) (pc + 3)] << 16);
+				break;
+
+			case 0xbf: case 0xdf: case 0x3f: case 0x1f:		// long,X
+			case 0x5f:
+				ea = (operand | (CPU.PCBase[(uint16) (pc + 3)] << 16)) + Registers.X.W;
+				break;
+
+			default:
+				return (-1);
+		}
+
+		if (read && !(S9xIdleLoopStableRead(ea, HVBJOY) && S9xIdleLoopStableRead(ea + 1, HVBJOY)))
+			return (0);
+
+		pc += len;
+		if ((uint16) (pc - Target) > (uint16) (End - 2 - Target))
+			return (-1);
+	}
+
+	return (1);
+}
+
+// The latest CPU.Cycles the loop may be fast-forwarded to: before the next
+// event, IRQ timer or NMI, so none of them can fall in a skipped iteration.
+static int32 S9xIdleLoopLimit (void)
+{
+	int32	limit = CPU.NextEvent;
+
+	if (Timings.NextIRQTimer < limit)
+		limit = Timings.NextIRQTimer;
+	if (CPU.NMIPending && Timings.NMITriggerPos < limit)
+		limit = Timings.NMITriggerPos;
+
+	return (limit);
+}
+
+// Not while S9xMainLoop() is about to return for the end of the frame
+static bool8 S9xIdleLoopCanSkip (void)
+{
+	return (!Settings.SA1 && CPU.PCBase && !CheckEmulation() && !Timings.IRQFlagChanging &&
+			!CPU.IRQLine && !CPU.IRQExternal && !CPU.InDMAorHDMA && !(CPU.Flags & SCAN_KEYS_FLAG));
+}
+
+// Called when a short branch back to Target = PCw has just been taken;
+// End is the address after the branch.
+void S9xIdleLoopBranch (uint16 End)
+{
+	uint32	branch = ICPU.ShiftedPB | End;
+	int32	last = IdleLoop.Cycles;
+	bool8	same;
+
+	if (branch == IdleLoop.Unsafe)
+		return;
+
+	same = IdleLoop.Branch == branch &&
+		   IdleLoop.Registers.A.W == Registers.A.W && IdleLoop.Registers.X.W == Registers.X.W &&
+		   IdleLoop.Registers.Y.W == Registers.Y.W && IdleLoop.Registers.D.W == Registers.D.W &&
+		   IdleLoop.Registers.S.W == Registers.S.W && IdleLoop.Registers.P.W == Registers.P.W &&
+		   IdleLoop.Registers.DB == Registers.DB && IdleLoop.Registers.PBPC == Registers.PBPC &&
+		   IdleLoop.OpenBus == OpenBus &&
+		   IdleLoop._Carry == ICPU._Carry && IdleLoop._Zero == ICPU._Zero &&
+		   IdleLoop._Negative == ICPU._Negative && IdleLoop._Overflow == ICPU._Overflow;
+
+	IdleLoop.Cycles = CPU.Cycles;
+
+	if (!same)
+	{
+		IdleLoop.Branch = branch;
+		IdleLoop.Registers = Registers;
+		IdleLoop.OpenBus = OpenBus;
+		IdleLoop._Carry = ICPU._Carry;
+		IdleLoop._Zero = ICPU._Zero;
+		IdleLoop._Negative = ICPU._Negative;
+		IdleLoop._Overflow = ICPU._Overflow;
+		return;
+	}
+
+	// One whole iteration ran from this state back to it, with no event or
+	// interrupt in between (they clear IdleLoop.Branch).
+	if (!S9xIdleLoopCanSkip())
+		return;
+
+	bool8	hvbjoy = false;
+	int		body = S9xIdleLoopBody(Registers.PCw, End, &hvbjoy);
+
+	if (body <= 0)
+	{
+		if (body < 0)
+			IdleLoop.Unsafe = branch;
+		return;
+	}
+
+	int32	period = CPU.Cycles - last;
+	int32	limit = S9xIdleLoopLimit();
+
+	// HVBJOY's H-blank bit must read the same as in the iteration just timed
+	if (hvbjoy && last < Timings.HBlankEnd && Timings.HBlankEnd < limit)
+		limit = Timings.HBlankEnd;
+
+	if (period <= 0 || CPU.Cycles + period >= limit)
+		return;
+
+	int32	skipped = (limit - 1 - CPU.Cycles) / period * period;
+
+	CPU.Cycles += skipped;
+	IdleLoop.Cycles = CPU.Cycles;
+	IdleLoop.Skips++;
+	IdleLoop.LoopCycles += skipped;
+}
+
+// Called by WAI, which the main loop runs again every MemSpeed + ONE_CYCLE
+// until an interrupt comes.
+void S9xIdleLoopWait (void)
+{
+	int32	period = CPU.MemSpeed + ONE_CYCLE;
+	int32	limit = S9xIdleLoopLimit();
+
+	if (!S9xIdleLoopCanSkip() || (Registers.PCw & MEMMAP_MASK) + 1 >= MEMMAP_BLOCK_SIZE ||
+		CPU.Cycles + period >= limit)
+		return;
+
+	int32	skipped = (limit - 1 - CPU.Cycles) / period * period;
+
+	CPU.Cycles += skipped;
+	IdleLoop.Skips++;
+	IdleLoop.WaitCycles += skipped;
+}
@@ -30,7 +30,26 @@ struct SICPU
 	uint32	FrameAdvanceCount;
 };
 
+// Idle-loop fast-forward. A short backwards branch that keeps arriving with
+// the same registers, and whose body only reads memory that can't change
+// until the next event, is spinning; the iterations up to that event are
+// skipped by adding their cycles at once. WAI is handled the same way.
+struct SIdleLoop
+{
+	uint32	Branch;			// PB:PC just past the branch being watched, 0 if none
+	int32	Cycles;			// CPU.Cycles when it was last taken
+	uint32	Unsafe;			// last branch whose body can't be skipped
+	struct SRegisters	Registers;
+	uint8	_Carry, _Zero, _Negative, _Overflow;
+	uint8	OpenBus;
+
+	uint32	Skips;
+	uint64	LoopCycles;		// cycles skipped in branch loops
+	uint64	WaitCycles;		// cycles skipped in WAI
+};
+
 extern struct SICPU		ICPU;
+extern struct SIdleLoop	IdleLoop;
 
 extern struct SOpcodes	S9xOpcodesE1[256];
 extern struct SOpcodes	S9xOpcodesM1X1[256];
@@ -47,6 +66,8 @@ void S9xMainLoop (void);
 void S9xReset (void);
 void S9xSoftReset (void);
 void S9xDoHEventProcessing (void);
+void S9xIdleLoopBranch (uint16);
+void S9xIdleLoopWait (void);
 
 static inline void S9xUnpackStatus (void)
 {
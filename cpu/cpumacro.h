@@ -108,8 +108,15 @@ static void Op##OP (void) \
 		if ((Registers.PCw & ~MEMMAP_MASK) != (newPC.W & ~MEMMAP_MASK)) \
 			S9xSetPCBase(ICPU.ShiftedPB + newPC.W); \
 		else \
+		{ \
+			uint16	end = Registers.PCw; \
 			Registers.PCw = newPC.W; \
+			if (!(E) && (uint16) (end - newPC.W) <= IDLE_LOOP_BYTES) \
+				IdleLoopBranch(end); \
+		} \
 	} \
+	else \
+		IdleLoopExit(); \
 }
 
 
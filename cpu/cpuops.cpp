@@ -15,10 +15,17 @@
 
 #ifdef SA1_OPCODES
 #define AddCycles(n)	{ SA1.Cycles += (n); }
+#define IdleLoopBranch(end)	((void) (end))
+#define IdleLoopExit()	((void) 0)
 #else
 #define AddCycles(n)	{ CPU.Cycles += (n); while (CPU.Cycles >= CPU.NextEvent) S9xDoHEventProcessing(); }
+#define IdleLoopBranch(end)	if (Settings.IdleLoopSkip) S9xIdleLoopBranch(end)
+#define IdleLoopExit()	(IdleLoop.Branch = 0)
 #endif
 
+// Longest loop, including its branch, that S9xIdleLoopBranch() looks at
+#define IDLE_LOOP_BYTES	16
+
 #include "cpu/cpuaddr.h"
 #include "cpu/cpuops.h"
 #include "cpu/cpumacro.h"
@@ -3323,6 +3330,9 @@ static void OpCB (void)
 
 	Registers.PCw--;
 	AddCycles(ONE_CYCLE);
+
+	if (Settings.IdleLoopSkip)
+		S9xIdleLoopWait();
 #endif
 }
 
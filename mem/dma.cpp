@@ -8,7 +8,7 @@
 #include "memmap.h"
 #include "dma.h"
 #include "apu/apu.h"
-#include "chips/sdd1emu.h"
+#include "chips/sdd1.h"
 #include "chips/spc7110emu.h"
 #ifdef DEBUGGER
 #endif
@@ -23,6 +23,7 @@ static uint8	sdd1_decode_buffer[0x10000];
 
 static inline bool8 addCyclesInDMA (uint8);
 static inline bool8 HDMAReadLineCount (int);
+static bool8 DoBulkDMA (SDMA *, uint8, uint8 *, uint16 &, int32 &, int32, int32 &);
 
 
 static inline bool8 addCyclesInDMA (uint8 dma_channel)
@@ -48,6 +49,204 @@ static inline bool8 addCyclesInDMA (uint8 dma_channel)
 	return true;
 }
 
+enum
+{
+	BULK_NONE,
+	BULK_OAM,
+	BULK_VRAM_L_LINEAR,
+	BULK_VRAM_L_TILE,
+	BULK_VRAM_H_LINEAR,
+	BULK_VRAM_H_TILE,
+	BULK_VRAM_LINEAR,
+	BULK_VRAM_TILE,
+	BULK_CGRAM,
+	BULK_WRAM,
+	BULK_WRAM_BLOCKED
+};
+
+static void WriteBulkDMA (int kind, uint8 *base, uint16 p, int32 inc, int32 n, int32 &b)
+{
+	#define SRC(k)	(*(base + (uint16) (p + (k) * inc)))
+
+	switch (kind)
+	{
+		case BULK_OAM:
+			for (int32 k = 0; k < n; k++)
+				REGISTER_2104(SRC(k));
+			break;
+
+		case BULK_VRAM_L_LINEAR:
+			for (int32 k = 0; k < n; k++)
+				REGISTER_2118_linear(SRC(k));
+			break;
+
+		case BULK_VRAM_L_TILE:
+			for (int32 k = 0; k < n; k++)
+				REGISTER_2118_tile(SRC(k));
+			break;
+
+		case BULK_VRAM_H_LINEAR:
+			for (int32 k = 0; k < n; k++)
+				REGISTER_2119_linear(SRC(k));
+			break;
+
+		case BULK_VRAM_H_TILE:
+			for (int32 k = 0; k < n; k++)
+				REGISTER_2119_tile(SRC(k));
+			break;
+
+		case BULK_VRAM_LINEAR:
+		{
+			int32	k = 0;
+
+			if (b && n)
+			{
+				OpenBus = SRC(0);
+				REGISTER_2119_linear(OpenBus);
+				b = 0;
+				k = 1;
+			}
+
+			if (PPU.VMA.High && PPU.VMA.Increment == 1 && inc == 1 && n - k >= 2)
+			{
+				// Straight word copy into VRAM.
+				uint32	address = (PPU.VMA.Address << 1) & 0xffff;
+				uint32	words = (n - k) & ~1;
+				uint32	len = words < 0x10000 - address ? words : 0x10000 - address;
+
+				memcpy(Memory.VRAM + address, base + p + k, len);
+				S9xInvalidateTileRange(address, len);
+				if (words > len)
+				{
+					memcpy(Memory.VRAM, base + p + k + len, words - len);
+					S9xInvalidateTileRange(0, words - len);
+				}
+
+				PPU.VMA.Address += words >> 1;
+				k += words;
+				OpenBus = SRC(k - 1);
+			}
+
+			for (; k < n; k++, b ^= 1)
+			{
+				if (!b)
+					REGISTER_2118_linear(SRC(k));
+				else
+				{
+					OpenBus = SRC(k);
+					REGISTER_2119_linear(OpenBus);
+				}
+			}
+
+			break;
+		}
+
+		case BULK_VRAM_TILE:
+			for (int32 k = 0; k < n; k++, b ^= 1)
+			{
+				if (!b)
+					REGISTER_2118_tile(SRC(k));
+				else
+					REGISTER_2119_tile(SRC(k));
+			}
+
+			break;
+
+		case BULK_CGRAM:
+			for (int32 k = 0; k < n; k++)
+				REGISTER_2122(SRC(k));
+			break;
+
+		case BULK_WRAM:
+			if (inc == 1)
+			{
+				for (int32 k = 0, len; k < n; k += len)
+				{
+					len = n - k;
+					if (len > (int32) (0x20000 - PPU.WRAM))
+						len = 0x20000 - PPU.WRAM;
+					memcpy(Memory.RAM + PPU.WRAM, base + p + k, len);
+					PPU.WRAM = (PPU.WRAM + len) & 0x1ffff;
+				}
+			}
+			else
+				for (int32 k = 0; k < n; k++)
+					REGISTER_2180(SRC(k));
+			break;
+
+		case BULK_WRAM_BLOCKED:
+			break;
+	}
+
+	#undef SRC
+}
+
+static bool8 DoBulkDMA (SDMA *d, uint8 Channel, uint8 *base, uint16 &p, int32 &count, int32 inc, int32 &b)
+{
+	// Nothing else runs between two H-events, so the bytes before the next one
+	// go out in a single run with one cycle adjustment, and only the byte that
+	// reaches it goes through addCyclesInDMA(). Targets whose writes depend on
+	// CPU.Cycles (APU ports, counters...) are left to the per-byte paths, as is
+	// anything left over when this returns. Returns false if HDMA killed the
+	// transfer. Like the fast paths, the register variant is picked up front.
+	int	kind = BULK_NONE;
+
+	if (d->TransferMode == 0 || d->TransferMode == 2 || d->TransferMode == 6)
+	{
+		switch (d->BAddress)
+		{
+			case 0x04: kind = BULK_OAM; break;
+			case 0x18: kind = PPU.VMA.FullGraphicCount ? BULK_VRAM_L_TILE : BULK_VRAM_L_LINEAR; break;
+			case 0x19: kind = PPU.VMA.FullGraphicCount ? BULK_VRAM_H_TILE : BULK_VRAM_H_LINEAR; break;
+			case 0x22: kind = BULK_CGRAM; break;
+			case 0x80: kind = CPU.InWRAMDMAorHDMA ? BULK_WRAM_BLOCKED : BULK_WRAM; break;
+		}
+	}
+	else
+	if ((d->TransferMode == 1 || d->TransferMode == 5) && d->BAddress == 0x18)
+		kind = PPU.VMA.FullGraphicCount ? BULK_VRAM_TILE : BULK_VRAM_LINEAR;
+
+	if (kind == BULK_NONE)
+		return (true);
+
+	bool8	vram = kind >= BULK_VRAM_L_LINEAR && kind <= BULK_VRAM_TILE;
+
+	while (count > 0 && !CPU.HDMARanInDMA)
+	{
+		// Outside blanking, CHECK_INBLANK may drop writes; leave those to the per-byte paths.
+		if (vram && !PPU.ForcedBlanking && CPU.V_Counter < PPU.ScreenHeight + FIRST_VISIBLE_LINE)
+			break;
+
+		int32	n = (CPU.NextEvent - CPU.Cycles - 1) / SLOW_ONE_CYCLE;
+		if (n > count)
+			n = count;
+
+		if (n > 0)
+		{
+			WriteBulkDMA(kind, base, p, inc, n, b);
+			CPU.Cycles += n * SLOW_ONE_CYCLE;
+			d->TransferBytes -= n;
+			d->AAddress += n * inc;
+			p += n * inc;
+			count -= n;
+
+			if (!count)
+				break;
+		}
+
+		WriteBulkDMA(kind, base, p, inc, 1, b);
+		d->TransferBytes--;
+		d->AAddress += inc;
+		p += inc;
+		count--;
+
+		if (!addCyclesInDMA(Channel))
+			return (false);
+	}
+
+	return (true);
+}
+
 bool8 S9xDoDMA (uint8 Channel)
 {
 	CPU.InDMA = true;
@@ -111,7 +310,10 @@ bool8 S9xDoDMA (uint8 Channel)
 		case 0x18:
 		case 0x19:
 			if (IPPU.RenderThisFrame)
+			{
 				FLUSH_REDRAW();
+				FLUSH_DEFERRED();
+			}
 			break;
 	}
 
@@ -140,7 +342,7 @@ bool8 S9xDoDMA (uint8 Channel)
 			if (in_ptr)
 			{
 				in_ptr += d->AAddress;
-				SDD1_decompress(sdd1_decode_buffer, in_ptr, d->TransferBytes);
+				S9xSDD1Decompress(sdd1_decode_buffer, in_ptr, d->TransferBytes);
 			}
 		#ifdef DEBUGGER
 			else
@@ -218,98 +420,20 @@ bool8 S9xDoDMA (uint8 Channel)
 				depth, count, bytes_per_char, bytes_per_line, num_chars, char_line_bytes);
 		#endif
 
-			switch (depth)
+			// Whole characters are converted, one character line of the bitmap
+			// per call, until the transfer is covered.
+			for (int32 i = 0; i < count; i += inc_sa1, base += char_line_bytes, inc_sa1 = char_line_bytes, char_count = num_chars)
 			{
-				case 2:
-					for (int32 i = 0; i < count; i += inc_sa1, base += char_line_bytes, inc_sa1 = char_line_bytes, char_count = num_chars)
-					{
-						uint8	*line = base + (num_chars - char_count) * 2;
-						for (uint32 j = 0; j < char_count && p - buffer < count; j++, line += 2)
-						{
-							uint8	*q = line;
-							for (int32 l = 0; l < 8; l++, q += bytes_per_line)
-							{
-								for (int32 b = 0; b < 2; b++)
-								{
-									uint8	r = *(q + b);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 0) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 1) & 1);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 2) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 3) & 1);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 4) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 5) & 1);
-									*(p + 0) = (*(p + 0) << 1) | ((r >> 6) & 1);
-									*(p + 1) = (*(p + 1) << 1) | ((r >> 7) & 1);
-								}
-
-								p += 2;
-							}
-						}
-					}
-
+				int32	left = count - (int32) (p - buffer);
+				if (left <= 0)
 					break;
 
-				case 4:
-					for (int32 i = 0; i < count; i += inc_sa1, base += char_line_bytes, inc_sa1 = char_line_bytes, char_count = num_chars)
-					{
-						uint8	*line = base + (num_chars - char_count) * 4;
-						for (uint32 j = 0; j < char_count && p - buffer < count; j++, line += 4)
-						{
-							uint8	*q = line;
-							for (int32 l = 0; l < 8; l++, q += bytes_per_line)
-							{
-								for (int32 b = 0; b < 4; b++)
-								{
-									uint8	r = *(q + b);
-									*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-									*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-									*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-									*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-									*(p +  0) = (*(p +  0) << 1) | ((r >> 4) & 1);
-									*(p +  1) = (*(p +  1) << 1) | ((r >> 5) & 1);
-									*(p + 16) = (*(p + 16) << 1) | ((r >> 6) & 1);
-									*(p + 17) = (*(p + 17) << 1) | ((r >> 7) & 1);
-								}
-
-								p += 2;
-							}
-
-							p += 32 - 16;
-						}
-					}
+				uint32	chars = (left + bytes_per_char - 1) / bytes_per_char;
+				if (chars > char_count)
+					chars = char_count;
 
-					break;
-
-				case 8:
-					for (int32 i = 0; i < count; i += inc_sa1, base += char_line_bytes, inc_sa1 = char_line_bytes, char_count = num_chars)
-					{
-						uint8	*line = base + (num_chars - char_count) * 8;
-						for (uint32 j = 0; j < char_count && p - buffer < count; j++, line += 8)
-						{
-							uint8	*q = line;
-							for (int32 l = 0; l < 8; l++, q += bytes_per_line)
-							{
-								for (int32 b = 0; b < 8; b++)
-								{
-									uint8	r = *(q + b);
-									*(p +  0) = (*(p +  0) << 1) | ((r >> 0) & 1);
-									*(p +  1) = (*(p +  1) << 1) | ((r >> 1) & 1);
-									*(p + 16) = (*(p + 16) << 1) | ((r >> 2) & 1);
-									*(p + 17) = (*(p + 17) << 1) | ((r >> 3) & 1);
-									*(p + 32) = (*(p + 32) << 1) | ((r >> 4) & 1);
-									*(p + 33) = (*(p + 33) << 1) | ((r >> 5) & 1);
-									*(p + 48) = (*(p + 48) << 1) | ((r >> 6) & 1);
-									*(p + 49) = (*(p + 49) << 1) | ((r >> 7) & 1);
-								}
-
-								p += 2;
-							}
-
-							p += 64 - 16;
-						}
-					}
-
-					break;
+				S9xSA1CharConv1(p, base + (num_chars - char_count) * depth, depth, bytes_per_line, chars);
+				p += chars * bytes_per_char;
 			}
 		}
 	}
@@ -552,6 +676,16 @@ bool8 S9xDoDMA (uint8 Channel)
 			#endif
 			}
 			else
+			if (!DoBulkDMA(d, Channel, base, p, count, inc, b))
+			{
+				CPU.InDMA = false;
+				CPU.InDMAorHDMA = false;
+				CPU.InWRAMDMAorHDMA = false;
+				CPU.CurrentDMAorHDMAChannel = -1;
+				return false;
+			}
+			else
+			if (count > 0)
 			{
 				// DMA FAST PATH
 				if (d->TransferMode == 0 || d->TransferMode == 2 || d->TransferMode == 6)
@@ -0,0 +1,532 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "snes9x.h"
+#include "memmap.h"
+#include "ppu.h"
+#include "gfx.h"
+#include "controls.h"
+#include "snapshot.h"
+#include "apu/apu.h"
+#include "savewriter.h"
+#include "lz.h"
+#include "hash.h"
+#include "inputlog.h"
+
+// ---------------------------------------------------------------------------
+// Records
+// ---------------------------------------------------------------------------
+
+enum
+{
+    KIND_PAD_LAST = 7,      // 0-7: change of that pad's buttons
+    KIND_HASH     = 0x40,
+    KIND_END      = 0xff
+};
+
+static const size_t HEADER_SIZE = 8 + 4 * 4;
+
+struct PadEvent
+{
+    uint64_t frame;
+    uint64_t sample;
+    uint8_t  pad;
+    uint16_t buttons;
+};
+
+struct FrameHash
+{
+    uint64_t frame;
+    uint64_t state;
+    uint64_t picture;
+};
+
+// ---------------------------------------------------------------------------
+// Module state
+// ---------------------------------------------------------------------------
+
+static SInputLogStatus       s_status;
+static uint64_t              s_sample = 0;      // Joypad samples so far in this frame
+
+// Recording
+static std::string           s_path;
+static std::vector<uint8_t>  s_snapshot;        // Packed, as in a .suspend file
+static std::vector<uint8_t>  s_records;
+static uint64_t              s_last_frame = 0;  // Frame of the last record
+static uint16_t              s_last_buttons[8];
+
+// Replay
+static std::vector<PadEvent>  s_events;
+static std::vector<FrameHash> s_hashes;
+static size_t                 s_next_event = 0;
+static size_t                 s_next_hash  = 0;
+static uint16_t               s_buttons[8];
+
+// ---------------------------------------------------------------------------
+// Encoding helpers
+// ---------------------------------------------------------------------------
+
+static void put_u16(std::vector<uint8_t> &out, uint16_t v)
+{
+    out.push_back(v & 0xff);
+    out.push_back(v >> 8);
+}
+
+static void put_u32(std::vector<uint8_t> &out, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back((v >> (i * 8)) & 0xff);
+}
+
+static void put_u64(std::vector<uint8_t> &out, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        out.push_back((v >> (i * 8)) & 0xff);
+}
+
+static void put_varint(std::vector<uint8_t> &out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+struct Reader
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    bool           ok = true;
+
+    uint64_t get(int bytes)
+    {
+        if (end - p < bytes)
+        {
+            ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; i++)
+            v |= (uint64_t)*p++ << (i * 8);
+        return v;
+    }
+
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (p >= end)
+                break;
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+// Start a record for the current frame
+static void put_record(uint8_t kind)
+{
+    put_varint(s_records, s_status.frame - s_last_frame);
+    s_records.push_back(kind);
+    s_last_frame = s_status.frame;
+}
+
+// ---------------------------------------------------------------------------
+// Frame hashes
+// ---------------------------------------------------------------------------
+
+// One value of the state, chained onto the hash so far
+static uint64_t hash_value(uint64_t h, uint64_t v)
+{
+    return S9xHash64(&v, sizeof(v), h);
+}
+
+// The machine as the game sees it: work RAM, VRAM, OAM, palette, SRAM, the
+// CPU registers and position in the frame, and the sound CPU's RAM and DSP
+// registers. Renderer and resampler internals are left out, so code paths
+// that only change how the output is produced hash the same.
+static uint64_t hash_state()
+{
+    uint64_t h = 0;
+
+    h = S9xHash64(Memory.RAM, sizeof(Memory.RAM), h);
+    h = S9xHash64(Memory.VRAM, sizeof(Memory.VRAM), h);
+    h = S9xHash64(Memory.SRAM, Memory.SRAMLiveSize, h); // Also SA-1 BW-RAM without a battery
+    h = S9xHash64(PPU.OAMData, sizeof(PPU.OAMData), h);
+    h = S9xHash64(PPU.CGDATA, sizeof(PPU.CGDATA), h);
+
+    h = hash_value(h, Registers.DB);
+    h = hash_value(h, Registers.P.W);
+    h = hash_value(h, Registers.A.W);
+    h = hash_value(h, Registers.D.W);
+    h = hash_value(h, Registers.S.W);
+    h = hash_value(h, Registers.X.W);
+    h = hash_value(h, Registers.Y.W);
+    h = hash_value(h, Registers.PC.xPBPC);
+    h = hash_value(h, (uint32)CPU.Cycles);
+    h = hash_value(h, (uint32)CPU.V_Counter);
+
+    h = S9xHash64(S9xAPURAM(), 0x10000, h);
+    for (int reg = 0; reg < 0x80; reg++)
+        h = hash_value(h, S9xAPUReadDSP(reg));
+
+    return h;
+}
+
+// The picture as displayed: a 256-pixel line of a native_line_width frame is
+// hashed as if each pixel had been doubled, like the default output.
+static uint64_t hash_picture(int width, int height)
+{
+    uint64_t h = 0;
+    uint16   wide[MAX_SNES_WIDTH];
+
+    h = hash_value(h, (uint32)width);
+    h = hash_value(h, (uint32)height);
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint16 *row = GFX.Screen + y * GFX.RealPPL;
+        if (GFX.MixedWidths && GFX.LineWidth[y] < width)
+        {
+            for (int x = 0; x < width / 2; x++)
+                wide[x * 2] = wide[x * 2 + 1] = row[x];
+            row = wide;
+        }
+        h = S9xHash64(row, width * sizeof(uint16), h);
+    }
+
+    return h;
+}
+
+// ---------------------------------------------------------------------------
+// Log files
+// ---------------------------------------------------------------------------
+
+static void reset_state()
+{
+    s_status = SInputLogStatus();
+    s_sample = 0;
+    s_path.clear();
+    s_snapshot.clear();
+    s_records.clear();
+    s_last_frame = 0;
+    s_events.clear();
+    s_hashes.clear();
+    s_next_event = 0;
+    s_next_hash  = 0;
+}
+
+static bool read_file(const char *path, std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    uint8_t chunk[65536];
+    size_t  len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk + len);
+    fclose(file);
+
+    return true;
+}
+
+// Parse the records after the snapshot into s_events and s_hashes
+static bool parse_records(Reader &r)
+{
+    uint64_t frame = 0;
+
+    while (r.ok)
+    {
+        frame += r.varint();
+        uint8_t kind = (uint8_t)r.get(1);
+        if (!r.ok)
+            break;
+
+        if (kind <= KIND_PAD_LAST)
+        {
+            PadEvent e;
+            e.frame   = frame;
+            e.sample  = r.varint();
+            e.pad     = kind;
+            e.buttons = (uint16_t)r.get(2);
+            s_events.push_back(e);
+        }
+        else if (kind == KIND_HASH)
+        {
+            FrameHash fh;
+            fh.frame   = frame;
+            fh.state   = r.get(8);
+            fh.picture = r.get(8);
+            s_hashes.push_back(fh);
+        }
+        else if (kind == KIND_END)
+        {
+            s_status.frames = frame;
+            return true;
+        }
+        else
+            break;
+    }
+
+    return false;
+}
+
+static void report(const char *msg)
+{
+    S9xMessage(S9X_INFO, S9X_MOVIE_INFO, msg);
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+bool InputLogRecord(const char *path, bool frame_hashes)
+{
+    InputLogStop();
+
+    if (Settings.StopEmulation)
+        return false;
+
+    std::vector<uint8_t> state(S9xFreezeSize());
+    if (!S9xFreezeGameMem(state.data(), (uint32)state.size()))
+        return false;
+
+    S9xPackLZ(state.data(), state.size(), s_snapshot);
+
+    s_path = path;
+    s_status.recording    = true;
+    s_status.frame_hashes = frame_hashes;
+    for (int pad = 0; pad < 8; pad++)
+        s_last_buttons[pad] = S9xGetJoypadButtons(pad);
+
+    return true;
+}
+
+bool InputLogReplay(const char *path)
+{
+    InputLogStop();
+
+    if (Settings.StopEmulation)
+        return false;
+
+    // The log may be a recording that is still on its way to disk
+    SaveWriterFlush();
+
+    std::vector<uint8_t> data;
+    if (!read_file(path, data))
+    {
+        S9xMessage(S9X_ERROR, S9X_FREEZE_FILE_NOT_FOUND, "Input log not found.");
+        return false;
+    }
+
+    Reader r = { data.data(), data.data() + data.size() };
+    if (data.size() < HEADER_SIZE || memcmp(data.data(), INPUTLOG_MAGIC, 8) != 0)
+    {
+        S9xMessage(S9X_ERROR, S9X_WRONG_FORMAT, "Not an input log.");
+        return false;
+    }
+    r.p += 8;
+
+    uint32_t version  = (uint32_t)r.get(4);
+    uint32_t crc32    = (uint32_t)r.get(4);
+    uint32_t flags    = (uint32_t)r.get(4);
+    uint32_t snapshot = (uint32_t)r.get(4);
+
+    if (version != INPUTLOG_VERSION)
+    {
+        S9xMessage(S9X_ERROR, S9X_WRONG_VERSION, "Input log is from a different version.");
+        return false;
+    }
+    if (crc32 != Memory.ROMCRC32)
+    {
+        S9xMessage(S9X_ERROR, S9X_WRONG_MOVIE_SNAPSHOT, "Input log was recorded with a different ROM.");
+        return false;
+    }
+
+    std::vector<uint8_t> state;
+    if ((size_t)(r.end - r.p) < snapshot ||
+        !S9xUnpackLZ(r.p, snapshot, state))
+    {
+        S9xMessage(S9X_ERROR, S9X_WRONG_FORMAT, "Input log is damaged.");
+        return false;
+    }
+    r.p += snapshot;
+
+    if (!parse_records(r))
+    {
+        reset_state();
+        S9xMessage(S9X_ERROR, S9X_WRONG_FORMAT, "Input log is damaged.");
+        return false;
+    }
+
+    if (S9xUnfreezeGameMem(state.data(), (uint32)state.size()) != SUCCESS)
+    {
+        reset_state();
+        S9xMessage(S9X_ERROR, S9X_WRONG_FORMAT, "Input log snapshot doesn't load.");
+        return false;
+    }
+
+    s_status.replaying    = true;
+    s_status.frame_hashes = (flags & INPUTLOG_FRAME_HASHES) != 0;
+    s_status.finished     = s_status.frames == 0;
+    for (int pad = 0; pad < 8; pad++)
+        s_buttons[pad] = S9xGetJoypadButtons(pad);
+
+    return true;
+}
+
+void InputLogStop()
+{
+    // A recording of no frames would only replace a useful one
+    if (s_status.recording && s_status.frame)
+    {
+        std::vector<uint8_t> data(INPUTLOG_MAGIC, INPUTLOG_MAGIC + 8);
+        data.reserve(HEADER_SIZE + s_snapshot.size() + s_records.size() + 16);
+        put_u32(data, INPUTLOG_VERSION);
+        put_u32(data, Memory.ROMCRC32);
+        put_u32(data, s_status.frame_hashes ? INPUTLOG_FRAME_HASHES : 0);
+        put_u32(data, (uint32_t)s_snapshot.size());
+        data.insert(data.end(), s_snapshot.begin(), s_snapshot.end());
+        data.insert(data.end(), s_records.begin(), s_records.end());
+
+        put_varint(data, s_status.frame - s_last_frame);
+        data.push_back(KIND_END);
+
+        char msg[256];
+        snprintf(msg, sizeof(msg), "Input log: recorded %llu frames to %s (%zu bytes)",
+                 (unsigned long long)s_status.frame, s_path.c_str(), data.size());
+        SaveWriterQueue(s_path, data);
+        report(msg);
+    }
+
+    reset_state();
+}
+
+bool InputLogActive()
+{
+    return s_status.recording || s_status.replaying;
+}
+
+bool InputLogReplaying()
+{
+    return s_status.replaying && !s_status.finished;
+}
+
+void InputLogPoll()
+{
+    if (s_status.recording)
+    {
+        for (int pad = 0; pad < 8; pad++)
+        {
+            uint16_t buttons = S9xGetJoypadButtons(pad);
+            if (buttons == s_last_buttons[pad])
+                continue;
+
+            put_record((uint8_t)pad);
+            put_varint(s_records, s_sample);
+            put_u16(s_records, buttons);
+            s_last_buttons[pad] = buttons;
+        }
+    }
+    else if (InputLogReplaying())
+    {
+        // Catch up on anything due by now, in case a changed code path
+        // samples the joypads fewer times than the recording did
+        while (s_next_event < s_events.size())
+        {
+            const PadEvent &e = s_events[s_next_event];
+            if (e.frame > s_status.frame || (e.frame == s_status.frame && e.sample > s_sample))
+                break;
+            s_buttons[e.pad] = e.buttons;
+            s_next_event++;
+        }
+
+        // Every pad, so input set by the frontend never gets through
+        for (int pad = 0; pad < 8; pad++)
+            S9xSetJoypadButtons(pad, s_buttons[pad]);
+    }
+
+    s_sample++;
+}
+
+void InputLogEndFrame(int width, int height)
+{
+    if (!InputLogActive() || s_status.finished)
+        return;
+
+    if (s_status.frame_hashes)
+    {
+        s_status.state_hash   = hash_state();
+        s_status.picture_hash = hash_picture(width, height);
+    }
+
+    if (s_status.recording && s_status.frame_hashes)
+    {
+        put_record(KIND_HASH);
+        put_u64(s_records, s_status.state_hash);
+        put_u64(s_records, s_status.picture_hash);
+    }
+    else if (s_status.replaying && s_status.frame_hashes)
+    {
+        while (s_next_hash < s_hashes.size() && s_hashes[s_next_hash].frame < s_status.frame)
+            s_next_hash++;
+
+        if (s_next_hash < s_hashes.size() && s_hashes[s_next_hash].frame == s_status.frame)
+        {
+            const FrameHash &fh = s_hashes[s_next_hash++];
+            bool state_ok   = fh.state == s_status.state_hash;
+            bool picture_ok = fh.picture == s_status.picture_hash;
+
+            s_status.hashes_checked++;
+            if (!state_ok)
+                s_status.state_mismatches++;
+            if (!picture_ok)
+                s_status.picture_mismatches++;
+            if ((!state_ok || !picture_ok) && s_status.first_mismatch < 0)
+                s_status.first_mismatch = (int64_t)s_status.frame;
+        }
+    }
+
+    s_status.frame++;
+    s_sample = 0;
+
+    if (s_status.replaying && s_status.frame >= s_status.frames)
+    {
+        s_status.finished = true;
+
+        char msg[256];
+        if (!s_status.hashes_checked)
+            snprintf(msg, sizeof(msg), "Input log: replayed %llu frames",
+                     (unsigned long long)s_status.frame);
+        else if (s_status.first_mismatch < 0)
+            snprintf(msg, sizeof(msg), "Input log: replayed %llu frames, all %llu frame hashes match",
+                     (unsigned long long)s_status.frame, (unsigned long long)s_status.hashes_checked);
+        else
+            snprintf(msg, sizeof(msg), "Input log: replayed %llu frames; state differs in %llu and picture in %llu of %llu, first at frame %lld",
+                     (unsigned long long)s_status.frame, (unsigned long long)s_status.state_mismatches,
+                     (unsigned long long)s_status.picture_mismatches,
+                     (unsigned long long)s_status.hashes_checked, (long long)s_status.first_mismatch);
+        report(msg);
+    }
+}
+
+void InputLogGetStatus(SInputLogStatus *status)
+{
+    *status = s_status;
+}
@@ -0,0 +1,56 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef SNES9X_INPUTLOG_H_
+#define SNES9X_INPUTLOG_H_
+
+#include <cstdint>
+
+// Input log: deterministic recording and replay of a session, for profiling
+// runs and A/B comparisons of code paths. A log starts with a snapshot packed
+// like a .suspend file, then holds each change of a joypad's buttons, stamped
+// with the frame and the joypad sample within that frame where the game saw
+// it. Optionally it also holds a hash of the machine state and of the picture
+// after every frame, which a replay compares against its own.
+//
+// File layout (little endian):
+//   "S9XINPUT", u32 version, u32 ROM CRC32, u32 flags, u32 snapshot size,
+//   snapshot (S9xPackLZ() of S9xFreezeGameMem()), then records:
+//   varint frame delta, u8 kind, and by kind:
+//     0-7   pad change:  varint sample index, u16 buttons
+//     0x40  frame hash:  u64 state, u64 picture (for the frame just run)
+//     0xff  end          (its frame is the number of frames recorded)
+
+#define INPUTLOG_MAGIC			"S9XINPUT"
+#define INPUTLOG_VERSION		2	// 2: xxHash64 frame hashes, SRAM up to SRAMLiveSize
+#define INPUTLOG_FRAME_HASHES	1	// flags
+
+struct SInputLogStatus
+{
+    bool     recording       = false;
+    bool     replaying       = false;   // Stays set after the last frame; see finished
+    bool     finished        = false;   // Replay reached the end of the log
+    bool     frame_hashes    = false;
+    uint64_t frame           = 0;       // Frames run since the log's snapshot
+    uint64_t frames          = 0;       // Replay: frames in the log
+    uint64_t hashes_checked  = 0;       // Replay: frames whose hashes were compared
+    uint64_t state_mismatches   = 0;
+    uint64_t picture_mismatches = 0;
+    int64_t  first_mismatch  = -1;      // Frame of the first mismatch, or -1
+    uint64_t state_hash      = 0;       // Hashes of the last frame, with frame_hashes
+    uint64_t picture_hash    = 0;
+};
+
+bool InputLogRecord(const char *path, bool frame_hashes); // Snapshot now, record from here
+bool InputLogReplay(const char *path);  // Load the log's snapshot and replay from it
+void InputLogStop();                    // Write out a recording (unless empty), or end a replay
+bool InputLogActive();
+bool InputLogReplaying();
+void InputLogPoll();                    // At every joypad sample, after the frontend's poll
+void InputLogEndFrame(int width, int height); // After every frame
+void InputLogGetStatus(SInputLogStatus *);
+
+#endif
@@ -16,6 +16,7 @@
 #include <sys/stat.h>
 
 #include "memmap.h"
+#include "romprobe.h"
 #include "apu/apu.h"
 #include "chips/fxemu.h"
 #include "chips/sdd1.h"
@@ -23,6 +24,7 @@
 #include "controls.h"
 #include "sha256.h"
 #include "snapshot.h"
+#include "savewriter.h"
 
 #ifndef SET_UI_COLOR
 #define SET_UI_COLOR(r, g, b) ;
@@ -757,7 +759,6 @@ static const uint32	crc32Table[256] =
 static void S9xDeinterleaveType1 (int, uint8 *);
 static void S9xDeinterleaveType2 (int, uint8 *);
 static void S9xDeinterleaveGD24 (int, uint8 *);
-static bool8 allASCII (uint8 *, int);
 static bool8 is_SufamiTurbo_BIOS (const uint8 *, uint32);
 static bool8 is_SufamiTurbo_Cart (const uint8 *, uint32);
 static bool8 is_BSCart_BIOS (const uint8 *, uint32);
@@ -892,6 +893,14 @@ bool8 CMemory::Init (void)
 	IPPU.TileCached[TILE_4BIT_EVEN] = (uint8 *) malloc(MAX_4BIT_TILES);
 	IPPU.TileCached[TILE_4BIT_ODD]  = (uint8 *) malloc(MAX_4BIT_TILES);
 
+	IPPU.TileStamp[TILE_2BIT]       = (uint32 *) malloc(MAX_2BIT_TILES * sizeof(uint32));
+	IPPU.TileStamp[TILE_4BIT]       = (uint32 *) malloc(MAX_4BIT_TILES * sizeof(uint32));
+	IPPU.TileStamp[TILE_8BIT]       = (uint32 *) malloc(MAX_8BIT_TILES * sizeof(uint32));
+	IPPU.TileStamp[TILE_2BIT_EVEN]  = (uint32 *) malloc(MAX_2BIT_TILES * sizeof(uint32));
+	IPPU.TileStamp[TILE_2BIT_ODD]   = (uint32 *) malloc(MAX_2BIT_TILES * sizeof(uint32));
+	IPPU.TileStamp[TILE_4BIT_EVEN]  = (uint32 *) malloc(MAX_4BIT_TILES * sizeof(uint32));
+	IPPU.TileStamp[TILE_4BIT_ODD]   = (uint32 *) malloc(MAX_4BIT_TILES * sizeof(uint32));
+
 	if (!IPPU.TileCache[TILE_2BIT]       ||
 		!IPPU.TileCache[TILE_4BIT]       ||
 		!IPPU.TileCache[TILE_8BIT]       ||
@@ -905,56 +914,47 @@ bool8 CMemory::Init (void)
 		!IPPU.TileCached[TILE_2BIT_EVEN] ||
 		!IPPU.TileCached[TILE_2BIT_ODD]  ||
 		!IPPU.TileCached[TILE_4BIT_EVEN] ||
-		!IPPU.TileCached[TILE_4BIT_ODD])
+		!IPPU.TileCached[TILE_4BIT_ODD]  ||
+		!IPPU.TileStamp[TILE_2BIT]       ||
+		!IPPU.TileStamp[TILE_4BIT]       ||
+		!IPPU.TileStamp[TILE_8BIT]       ||
+		!IPPU.TileStamp[TILE_2BIT_EVEN]  ||
+		!IPPU.TileStamp[TILE_2BIT_ODD]   ||
+		!IPPU.TileStamp[TILE_4BIT_EVEN]  ||
+		!IPPU.TileStamp[TILE_4BIT_ODD])
     {
 		Deinit();
 		return false;
     }
 
-	ROMStorage.resize(MAX_ROM_SIZE + 0x200 + 0x8000);
-	std::fill(ROMStorage.begin(), ROMStorage.end(), 0);
-	SRAMStorage.resize(SRAM_SIZE);
-	std::fill(SRAMStorage.begin(), SRAMStorage.end(), 0);
-	SRAM = &SRAMStorage[0];
-	memset(RAM, 0,  sizeof(RAM));
-	memset(VRAM, 0, sizeof(VRAM));
+	// calloc() leaves the pages untouched until they are written, so only
+	// as much of the ROM and SRAM buffers as the cartridge uses gets backed
+	// by memory. The tile caches are only read after a tile is converted,
+	// so they aren't cleared either; the hires ones stay untouched unless a
+	// game uses modes 5 or 6.
 
-	memset(IPPU.TileCache[TILE_2BIT], 0,       MAX_2BIT_TILES * 64);
-	memset(IPPU.TileCache[TILE_4BIT], 0,       MAX_4BIT_TILES * 64);
-	memset(IPPU.TileCache[TILE_8BIT], 0,       MAX_8BIT_TILES * 64);
-	memset(IPPU.TileCache[TILE_2BIT_EVEN], 0,  MAX_2BIT_TILES * 64);
-	memset(IPPU.TileCache[TILE_2BIT_ODD], 0,   MAX_2BIT_TILES * 64);
-	memset(IPPU.TileCache[TILE_4BIT_EVEN], 0,  MAX_4BIT_TILES * 64);
-	memset(IPPU.TileCache[TILE_4BIT_ODD], 0,   MAX_4BIT_TILES * 64);
-
-	memset(IPPU.TileCached[TILE_2BIT], 0,      MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT], 0,      MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_8BIT], 0,      MAX_8BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_EVEN], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_ODD], 0,  MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_EVEN], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_ODD], 0,  MAX_4BIT_TILES);
-
-	// FillRAM uses first 32K of ROM image area, otherwise space just
-	// wasted. Might be read by the SuperFX code.
+	ROMStorage     = (uint8 *) calloc(ROM_STORAGE_SIZE, 1);
+	ROMStorageOld  = nullptr;
+	ROMStorageUsed = false;
+	SRAM           = (uint8 *) calloc(SRAM_SIZE, 1);
+	SRAMLiveSize   = SRAM_SIZE;
 
-	FillRAM = &ROMStorage[0];
+	if (!ROMStorage || !SRAM)
+	{
+		Deinit();
+		return false;
+	}
 
-	// Add 0x8000 to ROM image pointer to stop SuperFX code accessing
-	// unallocated memory (can cause crash on some ports).
+	memset(RAM, 0,  sizeof(RAM));
+	memset(VRAM, 0, sizeof(VRAM));
 
-	ROM = &ROMStorage[0x8000];
+	S9xResetTileCache();
 
-	C4RAM   = ROM + 0x400000 + 8192 * 8; // C4
-	OBC1RAM = ROM + 0x400000; // OBC1
-	BIOSROM = ROM + 0x300000; // BS
-	BSRAM   = ROM + 0x400000; // BS
+	SetROMPointers();
 
-	SuperFX.pvRegisters = FillRAM + 0x3000;
 	SuperFX.nRamBanks   = 2; // Most only use 1.  1=64KB=512Mb, 2=128KB=1024Mb
 	SuperFX.pvRam       = SRAM;
 	SuperFX.nRomBanks   = (2 * 1024 * 1024) / (32 * 1024);
-	SuperFX.pvRom       = (uint8 *) ROM;
 
 	PostRomInitFunc = nullptr;
 
@@ -963,7 +963,11 @@ bool8 CMemory::Init (void)
 
 void CMemory::Deinit (void)
 {
-	ROM = nullptr;
+	free(ROMStorage);
+	free(ROMStorageOld);
+	free(SRAM);
+	ROMStorage = ROMStorageOld = nullptr;
+	ROM = FillRAM = SRAM = nullptr;
 
 	for (int t = 0; t < 7; t++)
 	{
@@ -978,22 +982,76 @@ void CMemory::Deinit (void)
 			free(IPPU.TileCached[t]);
 			IPPU.TileCached[t] = nullptr;
 		}
+
+		if (IPPU.TileStamp[t])
+		{
+			free(IPPU.TileStamp[t]);
+			IPPU.TileStamp[t] = nullptr;
+		}
 	}
 }
 
-// file management and ROM detection
+void CMemory::SetROMPointers (void)
+{
+	// FillRAM uses first 32K of ROM image area, otherwise space just
+	// wasted. Might be read by the SuperFX code.
+
+	FillRAM = ROMStorage;
+
+	// Add 0x8000 to ROM image pointer to stop SuperFX code accessing
+	// unallocated memory (can cause crash on some ports).
+
+	ROM = ROMStorage + 0x8000;
+
+	C4RAM   = ROM + 0x400000 + 8192 * 8; // C4
+	OBC1RAM = ROM + 0x400000; // OBC1
+	BIOSROM = ROM + 0x300000; // BS
+	BSRAM   = ROM + 0x400000; // BS
+
+	SuperFX.pvRegisters = FillRAM + 0x3000;
+	SuperFX.pvRom       = ROM;
+}
 
-static bool8 allASCII (uint8 *b, int size)
+// Zero the ROM buffer for the next cartridge. The one from Init() is still
+// clean the first time. After that, rather than touching every page of the
+// old buffer again, a fresh one is swapped in with FillRAM carried over; the
+// old one stays allocated until the new cartridge is mapped and reset, so a
+// failed load leaves nothing pointing at freed memory.
+void CMemory::ClearROM (void)
 {
-	for (int i = 0; i < size; i++)
+	if (!ROMStorageUsed)
 	{
-		if (b[i] < 32 || b[i] > 126)
-			return false;
+		ROMStorageUsed = true;
+		return;
 	}
 
-	return true;
+	uint8	*storage = (uint8 *) calloc(ROM_STORAGE_SIZE, 1);
+	if (!storage)
+	{
+		memset(ROM, 0, MAX_ROM_SIZE);
+		return;
+	}
+
+	memcpy(storage, FillRAM, 0x8000);
+
+	// On a retry nothing has been mapped onto the current buffer yet
+	if (ROMStorageOld)
+		free(ROMStorage);
+	else
+		ROMStorageOld = ROMStorage;
+
+	ROMStorage = storage;
+	SetROMPointers();
 }
 
+void CMemory::FreeOldROM (void)
+{
+	free(ROMStorageOld);
+	ROMStorageOld = nullptr;
+}
+
+// file management and ROM detection
+
 static bool8 is_SufamiTurbo_BIOS (const uint8 *data, uint32 size)
 {
 	if (size == 0x40000 &&
@@ -1055,102 +1113,12 @@ static bool8 is_GNEXT_Add_On (const uint8 *data, uint32 size)
 
 int CMemory::ScoreHiROM (bool8 skip_header, int32 romoff)
 {
-	uint8	*buf = ROM + 0xff00 + romoff + (skip_header ? 0x200 : 0);
-	int		score = 0;
-
-	// Check for extended HiROM expansion used in Mother 2 Deluxe et al.
-	// Looks for size byte 13 (8MB) and an actual ROM size greater than 4MB
-	if (buf[0xd7] == 13 && CalculatedSize > 1024 * 1024 * 4)
-		score += 3;
-
-	if (buf[0xd5] & 0x1)
-		score += 2;
-
-	// Mode23 is SA-1
-	if (buf[0xd5] == 0x23)
-		score -= 2;
-
-	if (buf[0xd4] == 0x20)
-		score += 2;
-
-	if ((buf[0xdc] + (buf[0xdd] << 8)) + (buf[0xde] + (buf[0xdf] << 8)) == 0xffff)
-	{
-		score += 2;
-		if (0 != (buf[0xde] + (buf[0xdf] << 8)))
-			score++;
-	}
-
-	if (buf[0xda] == 0x33)
-		score += 2;
-
-	if ((buf[0xd5] & 0xf) < 4)
-		score += 2;
-
-	if (!(buf[0xfd] & 0x80))
-		score -= 6;
-
-	if ((buf[0xfc] + (buf[0xfd] << 8)) > 0xffb0)
-		score -= 2; // reduced after looking at a scan by Cowering
-
-	if (CalculatedSize > 1024 * 1024 * 3)
-		score += 4;
-
-	if (buf[0xd7] > 12)
-		score -= 1;
-
-	if (!allASCII(&buf[0xb0], 6))
-		score -= 1;
-
-	if (!allASCII(&buf[0xc0], ROM_NAME_LEN - 1))
-		score -= 1;
-
-	return (score);
+	return (S9xScoreHiROMHeader(ROM + 0xff00 + romoff + (skip_header ? 0x200 : 0), CalculatedSize));
 }
 
 int CMemory::ScoreLoROM (bool8 skip_header, int32 romoff)
 {
-	uint8	*buf = ROM + 0x7f00 + romoff + (skip_header ? 0x200 : 0);
-	int		score = 0;
-
-	if (!(buf[0xd5] & 0x1))
-		score += 3;
-
-	// Mode23 is SA-1
-	if (buf[0xd5] == 0x23)
-		score += 2;
-
-	if ((buf[0xdc] + (buf[0xdd] << 8)) + (buf[0xde] + (buf[0xdf] << 8)) == 0xffff)
-	{
-		score += 2;
-		if (0 != (buf[0xde] + (buf[0xdf] << 8)))
-			score++;
-	}
-
-	if (buf[0xda] == 0x33)
-		score += 2;
-
-	if ((buf[0xd5] & 0xf) < 4)
-		score += 2;
-
-	if (!(buf[0xfd] & 0x80))
-		score -= 6;
-
-	if ((buf[0xfc] + (buf[0xfd] << 8)) > 0xffb0)
-		score -= 2; // reduced per Cowering suggestion
-
-	if (CalculatedSize <= 1024 * 1024 * 16)
-		score += 2;
-
-	if ((1 << (buf[0xd7] - 7)) > 48)
-		score -= 1;
-
-	if (!allASCII(&buf[0xb0], 6))
-		score -= 1;
-
-	if (!allASCII(&buf[0xc0], ROM_NAME_LEN - 1))
-		score -= 1;
-
-	return (score);
+	return (S9xScoreLoROMHeader(ROM + 0x7f00 + romoff + (skip_header ? 0x200 : 0), CalculatedSize));
 }
 
 int CMemory::First512BytesCountZeroes() const
@@ -1294,7 +1262,7 @@ bool8 CMemory::LoadROMMem (const uint8 *source, uint32 sourceSize, const char* o
 
     do
     {
-        memset(ROM,0, MAX_ROM_SIZE);
+        ClearROM();
         memset(&Multi, 0,sizeof(Multi));
         memcpy(ROM,source,sourceSize);
     }
@@ -1314,7 +1282,7 @@ bool8 CMemory::LoadROM (const char *filename)
 
     do
     {
-        memset(ROM,0, MAX_ROM_SIZE);
+        ClearROM();
         memset(&Multi, 0,sizeof(Multi));
         totalFileSize = FileLoader(ROM, filename, MAX_ROM_SIZE);
 
@@ -1536,6 +1504,7 @@ bool8 CMemory::LoadROMInt (int32 ROMfillSize)
 	InitROM();
 
 	S9xReset();
+	FreeOldROM();
 
     return true;
 }
@@ -1545,7 +1514,7 @@ bool8 CMemory::LoadMultiCartMem (const uint8 *sourceA, uint32 sourceASize,
                                  const uint8 *bios, uint32 biosSize)
 {
     uint32 offset = 0;
-    memset(ROM, 0, MAX_ROM_SIZE);
+    ClearROM();
 	memset(&Multi, 0, sizeof(Multi));
 
     if(bios) {
@@ -1579,7 +1548,7 @@ bool8 CMemory::LoadMultiCart (const char *cartA, const char *cartB)
 {
     S9xResetSaveTimer(false); // reset oops timer here so that .oops file has rom name of previous rom
 
-    memset(ROM, 0, MAX_ROM_SIZE);
+    ClearROM();
 	memset(&Multi, 0, sizeof(Multi));
 
 	SET_UI_COLOR(255, 255, 255);
@@ -1693,6 +1662,7 @@ bool8 CMemory::LoadMultiCartInt ()
 	InitROM();
 
 	S9xReset();
+	FreeOldROM();
 
 	return true;
 }
@@ -1782,6 +1752,8 @@ bool8 CMemory::LoadSRTC (void)
 {
 	FILE	*fp;
 
+	SaveWriterFlush();
+
 	fp = fopen(S9xGetFilename(".rtc", SRAM_DIR).c_str(), "rb");
 	if (!fp)
 		return false;
@@ -1795,17 +1767,7 @@ bool8 CMemory::LoadSRTC (void)
 
 bool8 CMemory::SaveSRTC (void)
 {
-	FILE	*fp;
-
-	fp = fopen(S9xGetFilename(".rtc", SRAM_DIR).c_str(), "wb");
-	if (!fp)
-		return false;
-
-	if (fwrite(RTCData.reg, 1, 20, fp) < 20)
-	{
-		printf ("Failed to save clock data.\n");
-	}
-	fclose(fp);
+	SaveWriterQueue(S9xGetFilename(".rtc", SRAM_DIR), RTCData.reg, 20);
 
 	return true;
 }
@@ -1815,8 +1777,7 @@ void CMemory::ClearSRAM (bool8 onlyNonSavedSRAM)
 	if (onlyNonSavedSRAM)
 		if (!(Settings.SuperFX && ROMType < 0x15) && !(Settings.SA1 && ROMType == 0x34)) // can have SRAM
 			return;
-	// TODO: If SRAM size changes change this value as well
-	memset(SRAM, SNESGameFixes.SRAMInitialValue, 0x80000);
+	memset(SRAM, SNESGameFixes.SRAMInitialValue, SRAMLiveSize);
 }
 
 bool8 CMemory::LoadSRAM (const char *filename)
@@ -1824,6 +1785,7 @@ bool8 CMemory::LoadSRAM (const char *filename)
 	FILE	*file;
 	int		size, len;
 
+	SaveWriterFlush(); // a save of this file may still be in flight
 	ClearSRAM();
 
 	if (Multi.cartType && Multi.sramSizeB)
@@ -1891,6 +1853,9 @@ bool8 CMemory::LoadSRAM (const char *filename)
 	return true;
 }
 
+// Returns whether the cartridge has SRAM to save. The files are only queued
+// here and written in the background, so a failed write isn't reported: the
+// save writer retries it on the next save, and SaveWriterFlush() waits for it.
 bool8 CMemory::SaveSRAM (const char *filename)
 {
 	if (Settings.SuperFX && ROMType < 0x15) // doesn't have SRAM
@@ -1899,7 +1864,6 @@ bool8 CMemory::SaveSRAM (const char *filename)
 	if (Settings.SA1 && ROMType == 0x34)    // doesn't have SRAM
 		return true;
 
-	FILE	*file;
 	int		size;
 
 	if (Multi.cartType && Multi.sramSizeB)
@@ -1907,13 +1871,7 @@ bool8 CMemory::SaveSRAM (const char *filename)
 		std::string name = S9xGetFilename(Multi.fileNameB, ".srm", SRAM_DIR);
 		size = (1 << (Multi.sramSizeB + 3)) * 128;
 
-		file = fopen(name.c_str(), "wb");
-		if (file)
-		{
-			if (!fwrite((char *) Multi.sramB, size, 1, file))
-				printf ("Couldn't write to subcart SRAM file.\n");
-			fclose(file);
-		}
+		SaveWriterQueue(name, Multi.sramB, size);
     }
 
     size = SRAMSize ? (1 << (SRAMSize + 3)) * 128 : 0;
@@ -1924,18 +1882,12 @@ bool8 CMemory::SaveSRAM (const char *filename)
 
 	if (size)
 	{
-		file = fopen(filename, "wb");
-		if (file)
-		{
-			if (!fwrite((char *) SRAM, size, 1, file))
-				printf ("Couldn't write to SRAM file.\n");
-			fclose(file);
+		SaveWriterQueue(filename, SRAM, size);
 
-			if (Settings.SRTC || Settings.SPC7110RTC)
-				SaveSRTC();
+		if (Settings.SRTC || Settings.SPC7110RTC)
+			SaveSRTC();
 
-			return true;
-		}
+		return true;
 	}
 
 	return false;
@@ -2400,6 +2352,34 @@ void CMemory::InitROM (void)
 
 	ApplyROMFixes();
 
+	//// SRAM the cartridge can reach, which is all a savestate has to keep
+
+	uint32	sram = SRAMMask + 1;
+
+	if (Settings.SA1)
+		sram = max(sram, 0x40000);
+	if (Settings.SuperFX)
+		sram = max(sram, SuperFX.nRamBanks * 0x10000);
+	if (Settings.BS)
+		sram = max(sram, 0x8000);
+	if (Multi.cartType)
+		sram = max(sram, max(Multi.sramMaskA, 0x10000 + Multi.sramMaskB) + 1);
+
+	// Banks mapped straight onto SRAM, at fixed offsets for some carts
+	for (int c = 0; c < MEMMAP_NUM_BLOCKS; c++)
+	{
+		uint8	*block[2] = { Map[c], WriteMap[c] };
+
+		for (uint8 *b : block)
+		{
+			uintptr_t	p = (uintptr_t) b + ((c << MEMMAP_SHIFT) & 0xffff);
+			if (p >= (uintptr_t) SRAM && p < (uintptr_t) SRAM + SRAM_SIZE)
+				sram = max(sram, (uint32) (p - (uintptr_t) SRAM) + MEMMAP_BLOCK_SIZE);
+		}
+	}
+
+	SRAMLiveSize = min(sram, (uint32) SRAM_SIZE);
+
 	//// Show ROM information
 	ROMId[4] = 0;
     strcpy(ROMId, SafeString(ROMId).c_str());
@@ -2675,6 +2655,28 @@ void CMemory::map_WriteProtectROM (void)
 	}
 }
 
+void CMemory::map_BlockSpeed (void)
+{
+	// Access time only depends on the address, so this holds for every mapping.
+	for (int c = 0; c < 0x1000; c++)
+	{
+		uint32	addr = c << MEMMAP_SHIFT;
+
+		if ((addr & 0x40f000) == 0x4000)
+			BlockSpeed[c] = 0;
+		else
+			BlockSpeed[c] = memory_speed(addr);
+	}
+}
+
+void CMemory::map_FastROMSpeed (void)
+{
+	// $80-$bf:8000-ffff and $c0-$ff:0000-ffff follow MEMSEL ($420d).
+	for (int c = 0x808; c < 0xc00; c += 0x10)
+		memset(BlockSpeed + c, CPU.FastROMSpeed, 8);
+	memset(BlockSpeed + 0xc00, CPU.FastROMSpeed, 0x400);
+}
+
 void CMemory::Map_Initialize (void)
 {
 	for (int c = 0; c < 0x1000; c++)
@@ -2684,6 +2686,8 @@ void CMemory::Map_Initialize (void)
 		BlockIsROM[c] = false;
 		BlockIsRAM[c] = false;
 	}
+
+	map_BlockSpeed();
 }
 
 void CMemory::Map_LoROMMap (void)
@@ -3155,6 +3159,422 @@ void CMemory::Map_BSCartHiROMMap(void)
 	map_WriteProtectROM();
 }
 
+// memory access
+
+#define SRAM_LOROM(mem, mask, a)	(*((mem) + (((((a) & 0xff0000) >> 1) | ((a) & 0x7fff)) & (mask))))
+#define SRAM_HIROM(a)				(*(Memory.SRAM + ((((a) & 0x7fff) - 0x6000 + (((a) & 0x1f0000) >> 3)) & Memory.SRAMMask)))
+
+static uint8 GetByteCPU (uint32 Address)
+{
+	return (S9xGetCPU(Address & 0xffff));
+}
+
+static uint8 GetBytePPU (uint32 Address)
+{
+	if (CPU.InDMAorHDMA && (Address & 0xff00) == 0x2100)
+		return (OpenBus);
+
+	return (S9xGetPPU(Address & 0xffff));
+}
+
+static uint8 GetByteLoROMSRAM (uint32 Address)
+{
+	// Address & 0x7fff   : offset into bank
+	// Address & 0xff0000 : bank
+	// bank >> 1 | offset : SRAM address, unbound
+	// unbound & SRAMMask : SRAM offset
+	return (SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address));
+}
+
+static uint8 GetByteLoROMSRAMB (uint32 Address)
+{
+	return (SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address));
+}
+
+static uint8 GetByteHiROMSRAM (uint32 Address)
+{
+	return (SRAM_HIROM(Address));
+}
+
+static uint8 GetByteBWRAM (uint32 Address)
+{
+	return (*(Memory.BWRAM + ((Address & 0x7fff) - 0x6000)));
+}
+
+static uint8 GetByteDSP (uint32 Address)
+{
+	return (S9xGetDSP(Address & 0xffff));
+}
+
+static uint8 GetByteSPC7110ROM (uint32 Address)
+{
+	return (S9xGetSPC7110Byte(Address));
+}
+
+static uint8 GetByteSPC7110DRAM (uint32 Address)
+{
+	return (S9xGetSPC7110(0x4800));
+}
+
+static uint8 GetByteC4 (uint32 Address)
+{
+	return (S9xGetC4(Address & 0xffff));
+}
+
+static uint8 GetByteOBC1 (uint32 Address)
+{
+	return (S9xGetOBC1(Address & 0xffff));
+}
+
+static uint8 GetByteNone (uint32 Address)
+{
+	return (OpenBus);
+}
+
+// Registers are read one byte at a time, each with its own access cycles.
+template <uint8 (*GetByte) (uint32)>
+static uint16 GetWordIO (uint32 Address, int32 speed)
+{
+	uint16	word;
+
+	word  = GetByte(Address);
+	addCyclesInMemoryAccess;
+	word |= GetByte(Address + 1) << 8;
+	addCyclesInMemoryAccess;
+	return (word);
+}
+
+static uint16 GetWordPPU (uint32 Address, int32 speed)
+{
+	if (CPU.InDMAorHDMA)
+	{
+		uint16	word = OpenBus = S9xGetByte(Address);
+		return (word | (S9xGetByte(Address + 1) << 8));
+	}
+
+	return (GetWordIO<GetBytePPU>(Address, speed));
+}
+
+static uint16 GetWordLoROMSRAM (uint32 Address, int32 speed)
+{
+	uint16	word;
+
+	if (Memory.SRAMMask >= MEMMAP_MASK)
+		word = READ_WORD(&SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address));
+	else
+		word = SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address) | (SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address + 1) << 8);
+	addCyclesInMemoryAccess_x2;
+	return (word);
+}
+
+static uint16 GetWordLoROMSRAMB (uint32 Address, int32 speed)
+{
+	uint16	word;
+
+	if (Multi.sramMaskB >= MEMMAP_MASK)
+		word = READ_WORD(&SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address));
+	else
+		word = SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address) | (SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address + 1) << 8);
+	addCyclesInMemoryAccess_x2;
+	return (word);
+}
+
+static uint16 GetWordHiROMSRAM (uint32 Address, int32 speed)
+{
+	uint16	word;
+
+	if (Memory.SRAMMask >= MEMMAP_MASK)
+		word = READ_WORD(&SRAM_HIROM(Address));
+	else
+		word = SRAM_HIROM(Address) | (SRAM_HIROM(Address + 1) << 8);
+	addCyclesInMemoryAccess_x2;
+	return (word);
+}
+
+static uint16 GetWordBWRAM (uint32 Address, int32 speed)
+{
+	uint16	word = READ_WORD(Memory.BWRAM + ((Address & 0x7fff) - 0x6000));
+	addCyclesInMemoryAccess_x2;
+	return (word);
+}
+
+static uint16 GetWordNone (uint32 Address, int32 speed)
+{
+	uint16	word = OpenBus | (OpenBus << 8);
+	addCyclesInMemoryAccess_x2;
+	return (word);
+}
+
+static void SetByteCPU (uint8 Byte, uint32 Address)
+{
+	S9xSetCPU(Byte, Address & 0xffff);
+}
+
+static void SetBytePPU (uint8 Byte, uint32 Address)
+{
+	if (CPU.InDMAorHDMA && (Address & 0xff00) == 0x2100)
+		return;
+
+	S9xSetPPU(Byte, Address & 0xffff);
+}
+
+static void SetByteLoROMSRAM (uint8 Byte, uint32 Address)
+{
+	if (Memory.SRAMMask)
+	{
+		SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address) = Byte;
+		CPU.SRAMModified = true;
+	}
+}
+
+static void SetByteLoROMSRAMB (uint8 Byte, uint32 Address)
+{
+	if (Multi.sramMaskB)
+	{
+		SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address) = Byte;
+		CPU.SRAMModified = true;
+	}
+}
+
+static void SetByteHiROMSRAM (uint8 Byte, uint32 Address)
+{
+	if (Memory.SRAMMask)
+	{
+		SRAM_HIROM(Address) = Byte;
+		CPU.SRAMModified = true;
+	}
+}
+
+static void SetByteBWRAM (uint8 Byte, uint32 Address)
+{
+	*(Memory.BWRAM + ((Address & 0x7fff) - 0x6000)) = Byte;
+	CPU.SRAMModified = true;
+}
+
+static void SetByteSA1RAM (uint8 Byte, uint32 Address)
+{
+	*(Memory.SRAM + (Address & 0xffff)) = Byte;
+}
+
+static void SetByteDSP (uint8 Byte, uint32 Address)
+{
+	S9xSetDSP(Byte, Address & 0xffff);
+}
+
+static void SetByteC4 (uint8 Byte, uint32 Address)
+{
+	S9xSetC4(Byte, Address & 0xffff);
+}
+
+static void SetByteOBC1 (uint8 Byte, uint32 Address)
+{
+	S9xSetOBC1(Byte, Address & 0xffff);
+}
+
+static void SetByteNone (uint8 Byte, uint32 Address)
+{
+}
+
+template <void (*SetByte) (uint8, uint32)>
+static void SetWordIO (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	if (o)
+	{
+		SetByte(Word >> 8, Address + 1);
+		addCyclesInMemoryAccess;
+		SetByte((uint8) Word, Address);
+		addCyclesInMemoryAccess;
+	}
+	else
+	{
+		SetByte((uint8) Word, Address);
+		addCyclesInMemoryAccess;
+		SetByte(Word >> 8, Address + 1);
+		addCyclesInMemoryAccess;
+	}
+}
+
+static void SetWordPPU (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	if (CPU.InDMAorHDMA)
+	{
+		if ((Address & 0xff00) != 0x2100)
+			S9xSetPPU((uint8) Word, Address & 0xffff);
+		if (((Address + 1) & 0xff00) != 0x2100)
+			S9xSetPPU(Word >> 8, (Address + 1) & 0xffff);
+		return;
+	}
+
+	SetWordIO<SetBytePPU>(Word, Address, o, speed);
+}
+
+static void SetWordLoROMSRAM (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	if (Memory.SRAMMask)
+	{
+		if (Memory.SRAMMask >= MEMMAP_MASK)
+			WRITE_WORD(&SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address), Word);
+		else
+		{
+			SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address) = (uint8) Word;
+			SRAM_LOROM(Memory.SRAM, Memory.SRAMMask, Address + 1) = Word >> 8;
+		}
+
+		CPU.SRAMModified = true;
+	}
+
+	addCyclesInMemoryAccess_x2;
+}
+
+static void SetWordLoROMSRAMB (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	if (Multi.sramMaskB)
+	{
+		if (Multi.sramMaskB >= MEMMAP_MASK)
+			WRITE_WORD(&SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address), Word);
+		else
+		{
+			SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address) = (uint8) Word;
+			SRAM_LOROM(Multi.sramB, Multi.sramMaskB, Address + 1) = Word >> 8;
+		}
+
+		CPU.SRAMModified = true;
+	}
+
+	addCyclesInMemoryAccess_x2;
+}
+
+static void SetWordHiROMSRAM (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	if (Memory.SRAMMask)
+	{
+		if (Memory.SRAMMask >= MEMMAP_MASK)
+			WRITE_WORD(&SRAM_HIROM(Address), Word);
+		else
+		{
+			SRAM_HIROM(Address) = (uint8) Word;
+			SRAM_HIROM(Address + 1) = Word >> 8;
+		}
+
+		CPU.SRAMModified = true;
+	}
+
+	addCyclesInMemoryAccess_x2;
+}
+
+static void SetWordBWRAM (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	WRITE_WORD(Memory.BWRAM + ((Address & 0x7fff) - 0x6000), Word);
+	CPU.SRAMModified = true;
+	addCyclesInMemoryAccess_x2;
+}
+
+static void SetWordSA1RAM (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	WRITE_WORD(Memory.SRAM + (Address & 0xffff), Word);
+	addCyclesInMemoryAccess_x2;
+}
+
+static void SetWordNone (uint16 Word, uint32 Address, enum s9xwriteorder_t o, int32 speed)
+{
+	addCyclesInMemoryAccess_x2;
+}
+
+#undef SRAM_LOROM
+#undef SRAM_HIROM
+
+const S9xGetByteHandler	S9xGetByteHandlers[CMemory::MAP_LAST] =
+{
+	GetByteCPU,				// MAP_CPU
+	GetBytePPU,				// MAP_PPU
+	GetByteLoROMSRAM,		// MAP_LOROM_SRAM
+	GetByteLoROMSRAMB,		// MAP_LOROM_SRAM_B
+	GetByteHiROMSRAM,		// MAP_HIROM_SRAM
+	GetByteDSP,				// MAP_DSP
+	GetByteLoROMSRAM,		// MAP_SA1RAM
+	GetByteBWRAM,			// MAP_BWRAM
+	GetByteNone,			// MAP_BWRAM_BITMAP
+	GetByteNone,			// MAP_BWRAM_BITMAP2
+	GetByteSPC7110ROM,		// MAP_SPC7110_ROM
+	GetByteSPC7110DRAM,		// MAP_SPC7110_DRAM
+	GetByteHiROMSRAM,		// MAP_RONLY_SRAM
+	GetByteC4,				// MAP_C4
+	GetByteOBC1,			// MAP_OBC_RAM
+	S9xGetSetaDSP,			// MAP_SETA_DSP
+	S9xGetST018,			// MAP_SETA_RISC
+	S9xGetBSX,				// MAP_BSX
+	GetByteNone				// MAP_NONE
+};
+
+const S9xGetWordHandler	S9xGetWordHandlers[CMemory::MAP_LAST] =
+{
+	GetWordIO<GetByteCPU>,			// MAP_CPU
+	GetWordPPU,						// MAP_PPU
+	GetWordLoROMSRAM,				// MAP_LOROM_SRAM
+	GetWordLoROMSRAMB,				// MAP_LOROM_SRAM_B
+	GetWordHiROMSRAM,				// MAP_HIROM_SRAM
+	GetWordIO<GetByteDSP>,			// MAP_DSP
+	GetWordLoROMSRAM,				// MAP_SA1RAM
+	GetWordBWRAM,					// MAP_BWRAM
+	GetWordNone,					// MAP_BWRAM_BITMAP
+	GetWordNone,					// MAP_BWRAM_BITMAP2
+	GetWordIO<GetByteSPC7110ROM>,	// MAP_SPC7110_ROM
+	GetWordIO<GetByteSPC7110DRAM>,	// MAP_SPC7110_DRAM
+	GetWordHiROMSRAM,				// MAP_RONLY_SRAM
+	GetWordIO<GetByteC4>,			// MAP_C4
+	GetWordIO<GetByteOBC1>,			// MAP_OBC_RAM
+	GetWordIO<S9xGetSetaDSP>,		// MAP_SETA_DSP
+	GetWordIO<S9xGetST018>,			// MAP_SETA_RISC
+	GetWordIO<S9xGetBSX>,			// MAP_BSX
+	GetWordNone						// MAP_NONE
+};
+
+const S9xSetByteHandler	S9xSetByteHandlers[CMemory::MAP_LAST] =
+{
+	SetByteCPU,				// MAP_CPU
+	SetBytePPU,				// MAP_PPU
+	SetByteLoROMSRAM,		// MAP_LOROM_SRAM
+	SetByteLoROMSRAMB,		// MAP_LOROM_SRAM_B
+	SetByteHiROMSRAM,		// MAP_HIROM_SRAM
+	SetByteDSP,				// MAP_DSP
+	SetByteSA1RAM,			// MAP_SA1RAM
+	SetByteBWRAM,			// MAP_BWRAM
+	SetByteNone,			// MAP_BWRAM_BITMAP
+	SetByteNone,			// MAP_BWRAM_BITMAP2
+	SetByteNone,			// MAP_SPC7110_ROM
+	SetByteNone,			// MAP_SPC7110_DRAM
+	SetByteNone,			// MAP_RONLY_SRAM
+	SetByteC4,				// MAP_C4
+	SetByteOBC1,			// MAP_OBC_RAM
+	S9xSetSetaDSP,			// MAP_SETA_DSP
+	S9xSetST018,			// MAP_SETA_RISC
+	S9xSetBSX,				// MAP_BSX
+	SetByteNone				// MAP_NONE
+};
+
+const S9xSetWordHandler	S9xSetWordHandlers[CMemory::MAP_LAST] =
+{
+	SetWordIO<SetByteCPU>,			// MAP_CPU
+	SetWordPPU,						// MAP_PPU
+	SetWordLoROMSRAM,				// MAP_LOROM_SRAM
+	SetWordLoROMSRAMB,				// MAP_LOROM_SRAM_B
+	SetWordHiROMSRAM,				// MAP_HIROM_SRAM
+	SetWordIO<SetByteDSP>,			// MAP_DSP
+	SetWordSA1RAM,					// MAP_SA1RAM
+	SetWordBWRAM,					// MAP_BWRAM
+	SetWordNone,					// MAP_BWRAM_BITMAP
+	SetWordNone,					// MAP_BWRAM_BITMAP2
+	SetWordNone,					// MAP_SPC7110_ROM
+	SetWordNone,					// MAP_SPC7110_DRAM
+	SetWordNone,					// MAP_RONLY_SRAM
+	SetWordIO<SetByteC4>,			// MAP_C4
+	SetWordIO<SetByteOBC1>,			// MAP_OBC_RAM
+	SetWordIO<S9xSetSetaDSP>,		// MAP_SETA_DSP
+	SetWordIO<S9xSetST018>,			// MAP_SETA_RISC
+	SetWordIO<S9xSetBSX>,			// MAP_BSX
+	SetWordNone						// MAP_NONE
+};
+
 // checksum
 
 uint16 CMemory::checksum_calc_sum (uint8 *data, uint32 length)
@@ -21,6 +21,9 @@ struct CMemory
 	enum
 	{ MAX_ROM_SIZE = 0xC00000 };
 
+	enum
+	{ ROM_STORAGE_SIZE = 0x8000 + MAX_ROM_SIZE + 0x200 };
+
 	enum file_formats
 	{ FILE_ZIP, FILE_JMA, FILE_DEFAULT };
 
@@ -58,9 +61,10 @@ struct CMemory
 	int32	HeaderCount;
 
 	uint8	RAM[0x20000];
-	std::vector<uint8_t> ROMStorage;
+	uint8	*ROMStorage;		// FillRAM, then the ROM image
+	uint8	*ROMStorageOld;		// the previous cartridge's, until it is replaced
+	bool8	ROMStorageUsed;
 	uint8   *ROM;
-	std::vector<uint8_t> SRAMStorage;
 	uint8	*SRAM;
 	const size_t SRAM_SIZE = 0x80000;
 	uint8	VRAM[0x10000];
@@ -75,6 +79,7 @@ struct CMemory
 	uint8	*WriteMap[MEMMAP_NUM_BLOCKS];
 	uint8	BlockIsRAM[MEMMAP_NUM_BLOCKS];
 	uint8	BlockIsROM[MEMMAP_NUM_BLOCKS];
+	uint8	BlockSpeed[MEMMAP_NUM_BLOCKS];
 	uint8	ExtendedFormat;
 
 	std::string ROMFilename;
@@ -95,6 +100,7 @@ struct CMemory
 	bool8	LoROM;
 	uint8	SRAMSize;
 	uint32	SRAMMask;
+	uint32	SRAMLiveSize;		// bytes of SRAM the cartridge can reach
 	uint32	CalculatedSize;
 	uint32	CalculatedChecksum;
 
@@ -103,6 +109,9 @@ struct CMemory
 
 	bool8	Init (void);
 	void	Deinit (void);
+	void	SetROMPointers (void);
+	void	ClearROM (void);
+	void	FreeOldROM (void);
 
 	int		ScoreHiROM (bool8, int32 romoff = 0);
 	int		ScoreLoROM (bool8, int32 romoff = 0);
@@ -145,6 +154,8 @@ struct CMemory
 	void	map_SetaRISC (void);
 	void	map_SetaDSP (void);
 	void	map_WriteProtectROM (void);
+	void	map_BlockSpeed (void);
+	void	map_FastROMSpeed (void);
 	void	Map_Initialize (void);
 	void	Map_LoROMMap (void);
 	void	Map_NoMAD1LoROMMap (void);
@@ -0,0 +1,559 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "snes9x.h"
+#include "memmap.h"
+#include "romprobe.h"
+
+static bool8 allASCII (const uint8 *b, int size)
+{
+	for (int i = 0; i < size; i++)
+	{
+		if (b[i] < 32 || b[i] > 126)
+			return false;
+	}
+
+	return true;
+}
+
+// Whether the header LoadROM() would use looks like a real one, so that a
+// scan can skip files that merely have a ROM extension. The reset vector must
+// point into ROM, and either the checksum and its complement must agree or
+// the map mode and ROM size bytes must be in range (for hacks and homebrew
+// with a stale checksum). header points $xfb0 into the image.
+static bool8 PlausibleHeader (const uint8 *header)
+{
+	uint16	reset      = header[0x4c] | (header[0x4d] << 8);
+	uint16	complement = header[0x2c] | (header[0x2d] << 8);
+	uint16	checksum   = header[0x2e] | (header[0x2f] << 8);
+	uint8	mode       = header[0x25];
+	uint8	size       = header[0x27];
+
+	if (reset < 0x8000)
+		return (false);
+
+	if ((checksum ^ complement) == 0xffff)
+		return (true);
+
+	return ((mode & 0xe0) == 0x20 && size >= 0x05 && size <= 0x0d);
+}
+
+// buf points $ff00 into the image
+int S9xScoreHiROMHeader (const uint8 *buf, uint32 CalculatedSize)
+{
+	int		score = 0;
+
+	// Check for extended HiROM expansion used in Mother 2 Deluxe et al.
+	// Looks for size byte 13 (8MB) and an actual ROM size greater than 4MB
+	if (buf[0xd7] == 13 && CalculatedSize > 1024 * 1024 * 4)
+		score += 3;
+
+	if (buf[0xd5] & 0x1)
+		score += 2;
+
+	// Mode23 is SA-1
+	if (buf[0xd5] == 0x23)
+		score -= 2;
+
+	if (buf[0xd4] == 0x20)
+		score += 2;
+
+	if ((buf[0xdc] + (buf[0xdd] << 8)) + (buf[0xde] + (buf[0xdf] << 8)) == 0xffff)
+	{
+		score += 2;
+		if (0 != (buf[0xde] + (buf[0xdf] << 8)))
+			score++;
+	}
+
+	if (buf[0xda] == 0x33)
+		score += 2;
+
+	if ((buf[0xd5] & 0xf) < 4)
+		score += 2;
+
+	if (!(buf[0xfd] & 0x80))
+		score -= 6;
+
+	if ((buf[0xfc] + (buf[0xfd] << 8)) > 0xffb0)
+		score -= 2; // reduced after looking at a scan by Cowering
+
+	if (CalculatedSize > 1024 * 1024 * 3)
+		score += 4;
+
+	if (buf[0xd7] > 12)
+		score -= 1;
+
+	if (!allASCII(&buf[0xb0], 6))
+		score -= 1;
+
+	if (!allASCII(&buf[0xc0], ROM_NAME_LEN - 1))
+		score -= 1;
+
+	return (score);
+}
+
+// buf points $7f00 into the image
+int S9xScoreLoROMHeader (const uint8 *buf, uint32 CalculatedSize)
+{
+	int		score = 0;
+
+	if (!(buf[0xd5] & 0x1))
+		score += 3;
+
+	// Mode23 is SA-1
+	if (buf[0xd5] == 0x23)
+		score += 2;
+
+	if ((buf[0xdc] + (buf[0xdd] << 8)) + (buf[0xde] + (buf[0xdf] << 8)) == 0xffff)
+	{
+		score += 2;
+		if (0 != (buf[0xde] + (buf[0xdf] << 8)))
+			score++;
+	}
+
+	if (buf[0xda] == 0x33)
+		score += 2;
+
+	if ((buf[0xd5] & 0xf) < 4)
+		score += 2;
+
+	if (!(buf[0xfd] & 0x80))
+		score -= 6;
+
+	if ((buf[0xfc] + (buf[0xfd] << 8)) > 0xffb0)
+		score -= 2; // reduced per Cowering suggestion
+
+	if (CalculatedSize <= 1024 * 1024 * 16)
+		score += 2;
+
+	if ((1 << (buf[0xd7] - 7)) > 48)
+		score -= 1;
+
+	if (!allASCII(&buf[0xb0], 6))
+		score -= 1;
+
+	if (!allASCII(&buf[0xc0], ROM_NAME_LEN - 1))
+		score -= 1;
+
+	return (score);
+}
+
+// The image as CMemory::LoadROMInt() would have rearranged it, read on demand.
+// An offset into the image goes back through the swapped ExHiROM fix and the
+// type 1 deinterleaves, last one first, to the file.
+struct ProbeImage
+{
+	int		fd;
+	uint32	skip;			// copier header bytes before the image
+	uint32	size;			// image bytes
+	uint32	deinterleave[3][2];	// type 1 deinterleaves: start, 64 KB block pairs
+	int		deinterleaved;
+	uint32	swap;			// swapped ExHiROM: size of the small half, or 0
+};
+
+static void ProbeDeinterleave (ProbeImage &img, uint32 start, uint32 size)
+{
+	img.deinterleave[img.deinterleaved][0] = start;
+	img.deinterleave[img.deinterleaved][1] = size >> 16;
+	img.deinterleaved++;
+}
+
+// Reads len bytes at offset; len must not cross a 32 KB block. Bytes past
+// the end of the image read as zero, like the unused part of Memory.ROM.
+static void ProbeRead (const ProbeImage &img, uint32 offset, uint8 *buf, uint32 len)
+{
+	if (img.swap)
+		offset = (offset < 0x400000) ? offset + img.swap : offset - 0x400000;
+
+	for (int i = img.deinterleaved - 1; i >= 0; i--)
+	{
+		uint32	start   = img.deinterleave[i][0];
+		uint32	nblocks = img.deinterleave[i][1];
+		uint32	block   = (offset - start) >> 15;
+
+		if (offset >= start && block < nblocks * 2)
+			offset = start + ((((block & 1) ? block >> 1 : (block >> 1) + nblocks) << 15) | (offset & 0x7fff));
+	}
+
+	memset(buf, 0, len);
+	if (offset < img.size && pread(img.fd, buf, std::min(len, img.size - offset), img.skip + offset) < 0)
+		memset(buf, 0, len);
+}
+
+static void ProbeScores (const ProbeImage &img, uint32 CalculatedSize, uint32 romoff, int &hi, int &lo)
+{
+	uint8	buf[0x100];
+
+	ProbeRead(img, romoff + 0xff00, buf, sizeof(buf));
+	hi = S9xScoreHiROMHeader(buf, CalculatedSize);
+	ProbeRead(img, romoff + 0x7f00, buf, sizeof(buf));
+	lo = S9xScoreLoROMHeader(buf, CalculatedSize);
+}
+
+static uint16 ProbeWord (const ProbeImage &img, uint32 offset)
+{
+	uint8	buf[2];
+
+	ProbeRead(img, offset, buf, 2);
+	return (buf[0] | (buf[1] << 8));
+}
+
+// The coprocessor CMemory::InitROM() would enable, named as in KartContents().
+// lorom is the $7fb0 header window, which the Super FX and Seta checks read
+// whatever the mapping.
+static const char * ProbeChip (const uint8 *RomHeader, const uint8 *lorom, uint8 &SRAMSize)
+{
+	uint8	ROMSpeed = RomHeader[0x25];
+	uint8	ROMType  = RomHeader[0x26];
+
+	if (ROMType == 0x03)
+		return ((ROMSpeed == 0x30) ? "+DSP-4" : "+DSP-1");
+
+	if (ROMType == 0x05)
+	{
+		if (ROMSpeed == 0x20)
+			return ("+DSP-2");
+		if (ROMSpeed == 0x30 && RomHeader[0x2a] == 0xb2)
+			return ("+DSP-3");
+		return ("+DSP-1");
+	}
+
+	switch ((ROMType << 8) + ROMSpeed)
+	{
+		case 0x5535:
+			return ("+S-RTC");
+
+		case 0xF93A:
+			return ("+SPC7110+RTC");
+
+		case 0xF53A:
+			return ("+SPC7110");
+
+		case 0x2530:
+			return ("+OBC1");
+
+		case 0x3423:
+		case 0x3523:
+			return ("+SA-1");
+
+		case 0x1320:
+		case 0x1420:
+		case 0x1520:
+		case 0x1A20:
+		case 0x1330:
+		case 0x1430:
+		case 0x1530:
+		case 0x1A30:
+			SRAMSize = (lorom[0x2a] == 0x33) ? lorom[0x0d] : 5;
+			return ("+Super FX");
+
+		case 0x4332:
+		case 0x4532:
+			return ("+S-DD1");
+
+		case 0xF530:
+			SRAMSize = 2;
+			return ("+ST-018");
+
+		case 0xF630:
+			SRAMSize = 2;
+			return ((lorom[0x27] == 0x09) ? "+ST-011" : "+ST-010");
+
+		case 0xF320:
+			return ("+C4");
+	}
+
+	return ("");
+}
+
+bool8 S9xProbeROMFd (int fd, SROMProbe *info)
+{
+	memset(info, 0, sizeof(*info));
+
+	struct stat	st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+		return (false);
+
+	info->FileSize = (uint32) std::min<off_t>(st.st_size, 0xffffffff);
+
+	// CMemory::FileLoader() and HeaderRemove()
+	uint32	filesize = std::min<uint32>(info->FileSize, CMemory::MAX_ROM_SIZE + 0x200);
+	uint32	fileskip = (filesize % 0x2000 == 512) ? 512 : 0;
+
+	// CMemory::LoadROMInt(), tried again without deinterleaving if the
+	// header lied about it
+	for (bool8 not_interleaved = false; ; not_interleaved = true)
+	{
+		ProbeImage	img = { fd, fileskip, filesize - fileskip, {}, 0, 0 };
+		int			hi_score, lo_score, hi, lo;
+
+		ProbeScores(img, 0, 0, hi_score, lo_score);
+		int	score_nonheadered = std::max(hi_score, lo_score);
+		ProbeScores(img, 0, 0x200, hi, lo);
+		int	score_headered = std::max(hi, lo);
+
+		uint8	first[512];
+		ProbeRead(img, 0, first, sizeof(first));
+		score_headered += (((img.size - 512) & 0xFFFF) == 0) ? 2 : -2;
+		score_headered += (std::count(first, first + 512, 0) >= 0x1E0) ? 2 : -2;
+
+		if (img.skip == 0 && score_headered > score_nonheadered)
+		{
+			img.skip = 512;
+			img.size -= 512;
+		}
+
+		uint32	CalculatedSize = ((img.size + 0x1fff) / 0x2000) * 0x2000;
+		uint16	lo_type = ProbeWord(img, 0x7fd5);
+		uint16	hi_type = ProbeWord(img, 0xffd5);
+		uint8	ExtendedFormat = CMemory::NOPE;
+
+		if (CalculatedSize > 0x400000 &&
+			lo_type != 0x1320 && lo_type != 0x1420 && lo_type != 0x1520 && lo_type != 0x1A20 && // exclude SuperFX
+			lo_type != 0x3423 && lo_type != 0x3523 && // exclude SA-1
+			lo_type != 0x4332 && lo_type != 0x4532 && // exclude S-DD1
+			hi_type != 0xF93a && hi_type != 0xF53a)   // exclude SPC7110
+			ExtendedFormat = CMemory::YEAH;
+
+		// if both vectors are invalid, it's type 1 interleaved LoROM
+		if (ExtendedFormat == CMemory::NOPE && !not_interleaved &&
+			ProbeWord(img, 0x7ffc) < 0x8000 && ProbeWord(img, 0xfffc) < 0x8000)
+		{
+			ProbeDeinterleave(img, 0, img.size);
+			info->Interleaved = true;
+		}
+
+		ProbeScores(img, CalculatedSize, 0, hi_score, lo_score);
+
+		uint32	header = 0;
+
+		if (ExtendedFormat != CMemory::NOPE)
+		{
+			ProbeScores(img, CalculatedSize, 0x400000, hi, lo);
+
+			if (std::max(lo, hi) >= std::max(lo_score, hi_score))
+			{
+				ExtendedFormat = CMemory::BIGFIRST;
+				hi_score = hi;
+				lo_score = lo;
+				header = 0x400000;
+			}
+			else
+				ExtendedFormat = CMemory::SMALLFIRST;
+		}
+
+		bool8	LoROM, interleaved = false, tales = false;
+		uint8	mode;
+
+		if (lo_score >= hi_score)
+		{
+			LoROM = true;
+			mode = ProbeWord(img, header + 0x7fd5) & 0xff;
+
+			// ignore map type byte if not 0x2x or 0x3x
+			if ((mode & 0xf0) == 0x20 || (mode & 0xf0) == 0x30)
+			{
+				interleaved = (mode & 0xf) == 1 || (mode & 0xf) == 5;
+				tales = (mode & 0xf) == 5;
+			}
+		}
+		else
+		{
+			LoROM = false;
+			mode = ProbeWord(img, header + 0xffd5) & 0xff;
+
+			if ((mode & 0xf0) == 0x20 || (mode & 0xf0) == 0x30)
+				interleaved = (mode & 0xf) == 0 || (mode & 0xf) == 3;
+		}
+
+		// this two games fail to be detected
+		uint8	title[22], title2[21];
+		ProbeRead(img, 0x7fc0, title, sizeof(title));
+		ProbeRead(img, 0xffc0, title2, sizeof(title2));
+		if (!memcmp(title, "YUYU NO QUIZ DE GO!GO!", 22) || !memcmp(title2, "BATMAN--REVENGE JOKER", 21))
+		{
+			LoROM = true;
+			interleaved = false;
+			tales = false;
+		}
+
+		if (!not_interleaved && interleaved)
+		{
+			info->Interleaved = true;
+
+			if (tales)
+			{
+				// Each ExHiROM half is deinterleaved on its own; the core
+				// can't load a smaller image declared this way
+				if (CalculatedSize < 0x400000)
+					return (false);
+
+				if (ExtendedFormat == CMemory::BIGFIRST)
+				{
+					ProbeDeinterleave(img, 0, 0x400000);
+					ProbeDeinterleave(img, 0x400000, CalculatedSize - 0x400000);
+				}
+				else
+				{
+					ProbeDeinterleave(img, 0, CalculatedSize - 0x400000);
+					ProbeDeinterleave(img, CalculatedSize - 0x400000, 0x400000);
+				}
+
+				LoROM = false;
+			}
+			else
+			{
+				LoROM = !LoROM;
+				ProbeDeinterleave(img, 0, CalculatedSize);
+				ProbeScores(img, CalculatedSize, 0, hi_score, lo_score);
+
+				if ((!LoROM && (lo_score >= hi_score || hi_score < 0)) ||
+					( LoROM && (hi_score >  lo_score || lo_score < 0)))
+				{
+					info->Interleaved = false;
+					continue;
+				}
+			}
+		}
+
+		if (ExtendedFormat == CMemory::SMALLFIRST)
+			tales = true;
+
+		if (tales)
+			img.swap = CalculatedSize - 0x400000;
+
+		// CMemory::InitROM() and ParseSNESHeader()
+		uint8	RomHeader[0x50], lorom[0x50];
+		ProbeRead(img, ((ExtendedFormat == CMemory::BIGFIRST) ? 0x400000 : 0) + (LoROM ? 0x7fb0 : 0xffb0), RomHeader, sizeof(RomHeader));
+		ProbeRead(img, 0x7fb0, lorom, sizeof(lorom));
+
+		memcpy(info->Name, &RomHeader[0x10], ROM_NAME_LEN - 1);
+		char	*p = info->Name + strlen(info->Name);
+		if (p > info->Name + 21 && info->Name[20] == ' ')
+			p = info->Name + 21;
+		while (p > info->Name && *(p - 1) == ' ')
+			p--;
+		*p = 0;
+
+		// As CMemory::SafeString()
+		memcpy(info->ROMId, &RomHeader[0x02], 4);
+		for (char *c = info->ROMId; *c; c++)
+		{
+			if (*c < 32 || *c > 126)
+				*c = '_';
+		}
+
+		strcpy(info->MapType, LoROM ? "LoROM" : (ExtendedFormat != CMemory::NOPE) ? "ExHiROM" : "HiROM");
+
+		info->ROMSize            = img.size;
+		info->MapMode            = RomHeader[0x25];
+		info->CartType           = RomHeader[0x26];
+		info->ROMSizeCode        = RomHeader[0x27];
+		info->SRAMSizeCode       = RomHeader[0x28];
+		info->Region             = RomHeader[0x29];
+		info->Version            = RomHeader[0x2B];
+		info->ComplementChecksum = RomHeader[0x2C] + (RomHeader[0x2D] << 8);
+		info->Checksum           = RomHeader[0x2E] + (RomHeader[0x2F] << 8);
+		info->CopierHeader       = img.skip != 0;
+		info->PAL                = (info->Region >= 2 && info->Region <= 12) || info->Region == 18;
+
+		static const char	*contents[3] = { "ROM", "ROM+RAM", "ROM+RAM+BAT" };
+		const char			*chip = ProbeChip(RomHeader, lorom, info->SRAMSizeCode);
+
+		if (info->CartType == 0)
+			strcpy(info->Contents, "ROM");
+		else
+			snprintf(info->Contents, sizeof(info->Contents), "%s%s", contents[(info->CartType & 0xf) % 3], chip);
+
+		info->Valid = PlausibleHeader(RomHeader);
+		return (info->Valid);
+	}
+}
+
+bool8 S9xProbeROM (const char *filename, SROMProbe *info)
+{
+	int	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		memset(info, 0, sizeof(*info));
+		return (false);
+	}
+
+	bool8	ok = S9xProbeROMFd(fd, info);
+	close(fd);
+
+	return (ok);
+}
+
+static void ListROMs (const std::string &dir, bool recursive, std::vector<std::string> &paths)
+{
+	DIR	*d = opendir(dir.c_str());
+	if (!d)
+		return;
+
+	while (struct dirent *entry = readdir(d))
+	{
+		if (entry->d_name[0] == '.')
+			continue;
+
+		std::string	path = dir + "/" + entry->d_name;
+		struct stat	st;
+		if (stat(path.c_str(), &st) != 0)
+			continue;
+
+		if (S_ISDIR(st.st_mode))
+		{
+			if (recursive)
+				ListROMs(path, recursive, paths);
+			continue;
+		}
+
+		const char	*ext = strrchr(entry->d_name, '.');
+		if (ext && (!strcasecmp(ext, ".sfc") || !strcasecmp(ext, ".smc") ||
+					!strcasecmp(ext, ".fig") || !strcasecmp(ext, ".swc")))
+			paths.push_back(path);
+	}
+
+	closedir(d);
+}
+
+void S9xProbeROMDirectory (const char *dir, bool recursive, int threads, std::vector<std::string> &paths, std::vector<SROMProbe> &results)
+{
+	paths.clear();
+	ListROMs(dir, recursive, paths);
+	std::sort(paths.begin(), paths.end());
+	results.assign(paths.size(), SROMProbe());
+
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::min<int>(threads, (int) paths.size());
+
+	// Each probe is a handful of small reads, so hand them out one at a time
+	std::atomic<size_t>			next(0);
+	std::vector<std::thread>	pool;
+
+	auto worker = [&]()
+	{
+		for (size_t i; (i = next++) < paths.size(); )
+			S9xProbeROM(paths[i].c_str(), &results[i]);
+	};
+
+	for (int i = 1; i < threads; i++)
+		pool.emplace_back(worker);
+	worker();
+
+	for (auto &t : pool)
+		t.join();
+}
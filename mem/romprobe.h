@@ -0,0 +1,56 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef SNES9X_ROMPROBE_H_
+#define SNES9X_ROMPROBE_H_
+
+#include <string>
+#include <vector>
+#include "snes9x.h"
+
+// Cartridge information read straight from a ROM file, for library scans.
+// S9xProbeROM() makes the same copier header, LoROM/HiROM and ExHiROM
+// decisions as CMemory::LoadROM(), but reads only the few header windows it
+// scores (with pread). It doesn't use Memory or Settings, so the Force*
+// overrides don't apply, and it is safe to call from several threads at once.
+// Plain image files only: archives, patches and BS-X/Sufami Turbo carts are
+// not recognised. A file whose chosen header doesn't look like a SNES header
+// (see S9xProbeROMFd()) comes back with Valid false.
+
+struct SROMProbe
+{
+	char	Name[ROM_NAME_LEN];	// header title, trailing spaces trimmed
+	char	ROMId[5];
+	char	MapType[8];			// "LoROM", "HiROM" or "ExHiROM"
+	char	Contents[24];		// "ROM+RAM+BAT+SA-1", as CMemory::KartContents()
+	uint32	FileSize;
+	uint32	ROMSize;			// image size without the copier header
+	uint16	Checksum;
+	uint16	ComplementChecksum;
+	uint8	MapMode;			// header $xxD5
+	uint8	CartType;			// header $xxD6
+	uint8	ROMSizeCode;		// header $xxD7
+	uint8	SRAMSizeCode;		// header $xxD8, or what the chip implies
+	uint8	Region;				// header $xxD9
+	uint8	Version;			// header $xxDB
+	bool8	Valid;				// the file holds a plausible SNES header
+	bool8	PAL;
+	bool8	CopierHeader;		// a 512-byte copier header was skipped
+	bool8	Interleaved;		// the image is stored interleaved
+};
+
+int S9xScoreHiROMHeader (const uint8 *, uint32);
+int S9xScoreLoROMHeader (const uint8 *, uint32);
+
+bool8 S9xProbeROM (const char *, SROMProbe *);
+bool8 S9xProbeROMFd (int, SROMProbe *);
+
+// Probe every ROM image (.sfc, .smc, .fig, .swc) in a directory, optionally
+// including subdirectories, on up to threads workers (0 = one per core).
+// paths and results come back sorted by path, one entry each.
+void S9xProbeROMDirectory (const char *, bool, int, std::vector<std::string> &, std::vector<SROMProbe> &);
+
+#endif
@@ -0,0 +1,247 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "savewriter.h"
+#include "lz.h"
+#include "hash.h"
+
+// ---------------------------------------------------------------------------
+// Per-file slot
+// ---------------------------------------------------------------------------
+
+// Each path owns one pending buffer. The worker swaps it with its own buffer
+// before writing, so the emulation thread can refill the slot while the
+// previous copy is still on its way to disk. A newer save replaces a pending
+// one that hasn't started yet.
+struct SaveSlot
+{
+    std::string          path;
+    std::vector<uint8_t> data;
+    uint64_t             hash   = 0;     // hash of the last copy queued
+    bool                 queued = false;
+    bool                 pack   = false;
+    double               write_ms    = 0.0; // last completed write, including packing
+    size_t               write_bytes = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Module state
+// ---------------------------------------------------------------------------
+
+static std::mutex              s_lock;
+static std::condition_variable s_wake;     // work queued or stop requested
+static std::condition_variable s_idle;     // a write finished
+static std::vector<SaveSlot>   s_slots;
+static std::thread             s_worker;
+static bool                    s_busy = false;
+static bool                    s_stop = false;
+
+// ---------------------------------------------------------------------------
+// Helpers
+// ---------------------------------------------------------------------------
+
+static bool write_file(const std::string &path, const std::vector<uint8_t> &data)
+{
+    std::string tmp = path + ".tmp";
+
+    FILE *file = fopen(tmp.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(data.data(), data.size(), 1, file) == 1;
+    ok = fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+
+    if (ok && rename(tmp.c_str(), path.c_str()) == 0)
+        return true;
+
+    remove(tmp.c_str());
+    return false;
+}
+
+static void worker_main()
+{
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> packed;
+    std::string          path;
+
+    std::unique_lock<std::mutex> lock(s_lock);
+
+    for (;;)
+    {
+        SaveSlot *slot = nullptr;
+        for (auto &s : s_slots)
+            if (s.queued)
+            {
+                slot = &s;
+                break;
+            }
+
+        if (!slot)
+        {
+            if (s_stop)
+                return;
+            s_wake.wait(lock);
+            continue;
+        }
+
+        buffer.swap(slot->data);
+        path = slot->path;
+        bool pack = slot->pack;
+        slot->queued = false;
+        s_busy = true;
+
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        if (pack)
+            S9xPackLZ(buffer.data(), buffer.size(), packed);
+        const std::vector<uint8_t> &out = pack ? packed : buffer;
+        bool ok = write_file(path, out);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+
+        if (!ok)
+            printf("Couldn't write to save file %s.\n", path.c_str());
+
+        // s_slots may have grown while unlocked, so look the slot up again.
+        for (auto &s : s_slots)
+        {
+            if (s.path != path)
+                continue;
+
+            if (ok)
+            {
+                s.write_ms    = ms;
+                s.write_bytes = out.size();
+            }
+            else if (!s.queued)
+                s.hash = 0; // retry on the next save even if unchanged
+        }
+
+        s_busy = false;
+        s_idle.notify_all();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+// Called with s_lock held. Returns the slot to fill, or nullptr if the data
+// matches the last copy queued for this path.
+static SaveSlot *claim_slot(const std::string &path, uint64_t hash, bool pack)
+{
+    SaveSlot *slot = nullptr;
+    for (auto &s : s_slots)
+        if (s.path == path)
+        {
+            slot = &s;
+            break;
+        }
+
+    if (!slot)
+    {
+        s_slots.emplace_back();
+        slot = &s_slots.back();
+        slot->path = path;
+    }
+    else if (slot->hash == hash)
+        return nullptr;
+
+    slot->hash = hash;
+    slot->queued = true;
+    slot->pack = pack;
+
+    s_stop = false;
+    if (!s_worker.joinable())
+        s_worker = std::thread(worker_main);
+    s_wake.notify_one();
+
+    return slot;
+}
+
+void SaveWriterQueue(const std::string &path, const void *data, size_t size, bool pack)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint64_t       hash  = S9xHash64(bytes, size);
+
+    std::lock_guard<std::mutex> guard(s_lock);
+
+    if (SaveSlot *slot = claim_slot(path, hash, pack))
+        slot->data.assign(bytes, bytes + size);
+}
+
+void SaveWriterQueue(const std::string &path, std::vector<uint8_t> &data, bool pack)
+{
+    uint64_t hash = S9xHash64(data.data(), data.size());
+
+    std::lock_guard<std::mutex> guard(s_lock);
+
+    if (SaveSlot *slot = claim_slot(path, hash, pack))
+        slot->data.swap(data);
+}
+
+bool SaveWriterLastWrite(const std::string &path, double *ms, size_t *bytes)
+{
+    std::lock_guard<std::mutex> guard(s_lock);
+
+    for (auto &s : s_slots)
+        if (s.path == path && s.write_bytes)
+        {
+            *ms    = s.write_ms;
+            *bytes = s.write_bytes;
+            return true;
+        }
+
+    return false;
+}
+
+void SaveWriterFlush()
+{
+    std::unique_lock<std::mutex> lock(s_lock);
+
+    for (;;)
+    {
+        bool pending = s_busy;
+        for (auto &s : s_slots)
+            pending |= s.queued;
+
+        if (!pending || !s_worker.joinable())
+            return;
+        s_idle.wait(lock);
+    }
+}
+
+void SaveWriterDeinit()
+{
+    {
+        std::lock_guard<std::mutex> guard(s_lock);
+        s_stop = true;
+        s_wake.notify_one();
+    }
+
+    // The worker drains every queued slot before it sees s_stop.
+    if (s_worker.joinable())
+        s_worker.join();
+
+    s_slots.clear();
+}
+
+// A frontend that exits without Emulator::Shutdown() still gets its saves,
+// and std::thread isn't destroyed while joinable.
+static struct SaveWriterAtExit
+{
+    ~SaveWriterAtExit() { SaveWriterDeinit(); }
+} s_at_exit;
@@ -0,0 +1,30 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef SNES9X_SAVEWRITER_H_
+#define SNES9X_SAVEWRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Background writer for save files (.srm, .rtc, .suspend).
+// SaveWriterQueue() copies the data and returns; a worker thread writes it to
+// a temp file and renames it over the target, so a slow flash device never
+// stalls the emulation thread and an interrupted write never truncates a save.
+// Data whose hash matches the last copy queued for the same path is skipped.
+// With pack set, the worker compresses the data with S9xPackLZ() first.
+
+void SaveWriterQueue(const std::string &path, const void *data, size_t size, bool pack = false);
+// Same, but takes over data's buffer instead of copying it; data is left
+// holding a spare buffer of unspecified contents and size.
+void SaveWriterQueue(const std::string &path, std::vector<uint8_t> &data, bool pack = false);
+bool SaveWriterLastWrite(const std::string &path, double *ms, size_t *bytes); // Time and size of the last completed write
+void SaveWriterFlush();  // Block until every queued write has reached disk
+void SaveWriterDeinit(); // Flush, then stop the worker thread
+
+#endif
@@ -27,7 +27,8 @@
  *   DMA - struct SDMA, DMA/HDMA state
  *   VRA - Memory.VRAM, 0x10000 bytes
  *   RAM - Memory.RAM, 0x20000 bytes (WRAM)
- *   SRA - Memory.SRAM, 0x20000 bytes
+ *   SRA - Memory.SRAM, Memory.SRAMLiveSize bytes (older saves have all 0x80000;
+ *         the extra bytes are out of the cartridge's reach and are skipped)
  *   FIL - Memory.FillRAM, 0x8000 bytes (register backing store)
  *   SND - All sound emulated registers and state variables
  *   CTL - struct SControlSnapshot, controller emulation
@@ -977,8 +978,20 @@ static FreezeData	SnapSPC7110Snap[] =
 	O(  0), O(  1), O(  2), O(  3), O(  4), O(  5), O(  6), O(  7),
 	O(  8), O(  9), O( 10), O( 11), O( 12), O( 13), O( 14), O( 15),
 	O( 16), O( 17), O( 18), O( 19), O( 20), O( 21), O( 22), O( 23),
-	O( 24), O( 25), O( 26), O( 27), O( 28), O( 29), O( 30), O( 31)
+	O( 24), O( 25), O( 26), O( 27), O( 28), O( 29), O( 30), O( 31),
 #undef O
+	ARRAY_ENTRY(13, decoder.pixelorder, 16, uint32_ARRAY_V),
+	ARRAY_ENTRY(13, decoder.bitplanebuffer, 16, uint8_ARRAY_V),
+	INT_ENTRY(13, decoder.buffer_index),
+	INT_ENTRY(13, decoder.in),
+	INT_ENTRY(13, decoder.val),
+	INT_ENTRY(13, decoder.span),
+	INT_ENTRY(13, decoder.out),
+	INT_ENTRY(13, decoder.out0),
+	INT_ENTRY(13, decoder.out1),
+	INT_ENTRY(13, decoder.inverts),
+	INT_ENTRY(13, decoder.lps),
+	INT_ENTRY(13, decoder.in_count)
 };
 
 #undef STRUCT
@@ -1217,7 +1230,7 @@ void S9xFreezeToStream (STREAM stream)
 
 	FreezeBlock (stream, "RAM", Memory.RAM, sizeof(Memory.RAM));
 
-	FreezeBlock (stream, "SRA", Memory.SRAM, Memory.SRAM_SIZE);
+	FreezeBlock (stream, "SRA", Memory.SRAM, Memory.SRAMLiveSize);
 
 	FreezeBlock (stream, "FIL", Memory.FillRAM, 0x8000);
 
@@ -1373,9 +1386,9 @@ int S9xUnfreezeFromStream (STREAM stream)
 			break;
 
 		if (fast)
-			result = UnfreezeBlock(stream, "SRA", Memory.SRAM, Memory.SRAM_SIZE);
+			result = UnfreezeBlock(stream, "SRA", Memory.SRAM, Memory.SRAMLiveSize);
 		else
-			result = UnfreezeBlockCopy (stream, "SRA", &local_sram, Memory.SRAM_SIZE);
+			result = UnfreezeBlockCopy (stream, "SRA", &local_sram, Memory.SRAMLiveSize);
 		if (result != SUCCESS)
 			break;
 
@@ -1514,7 +1527,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 			memcpy(Memory.RAM, local_ram, 0x20000);
 
 		if (local_sram)
-			memcpy(Memory.SRAM, local_sram, Memory.SRAM_SIZE);
+			memcpy(Memory.SRAM, local_sram, Memory.SRAMLiveSize);
 
 		if (local_fillram)
 			memcpy(Memory.FillRAM, local_fillram, 0x8000);
@@ -1640,11 +1653,13 @@ int S9xUnfreezeFromStream (STREAM stream)
 		CPU.Flags |= old_flags & (DEBUG_MODE_FLAG | TRACE_FLAG | SINGLE_STEP_FLAG | FRAME_ADVANCE_FLAG);
 		ICPU.ShiftedPB = Registers.PB << 16;
 		ICPU.ShiftedDB = Registers.DB << 16;
+		Memory.map_FastROMSpeed();
 		S9xSetPCBase(Registers.PBPC);
 		S9xUnpackStatus();
 		if(version < SNAPSHOT_VERSION_IRQ_2018)
 			S9xUpdateIRQPositions(false); // calculate the new trigger pos from saved PPU data
 		S9xFixCycles();
+		IdleLoop.Branch = 0;
 
 		for (int d = 0; d < 8; d++)
 			DMA[d] = dma_snap.dma[d];
@@ -1710,6 +1725,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 			const bool8 scaleDownX = IPPU.RenderedScreenWidth  < ssi->Width;
 			const bool8 scaleDownY = IPPU.RenderedScreenHeight < ssi->Height && ssi->Height > SNES_HEIGHT_EXTENDED;
 			GFX.DoInterlace = ssi->Interlaced;
+			GFX.MixedWidths = false;
 
 			uint8	*rowpix = ssi->Data;
 			uint16	*screen = GFX.Screen;
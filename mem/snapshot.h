@@ -11,7 +11,8 @@
 #define SNAPSHOT_VERSION_IRQ		7
 #define SNAPSHOT_VERSION_BAPU		8
 #define SNAPSHOT_VERSION_IRQ_2018	11		// irq changes were introduced earlier, since this we store NextIRQTimer directly
-#define SNAPSHOT_VERSION			12
+#define SNAPSHOT_VERSION_SPC7110_DECODER	13	// SPC7110 decompressor state is saved mid-stream
+#define SNAPSHOT_VERSION			13
 
 #define SUCCESS					1
 #define WRONG_FORMAT			(-1)
@@ -19,10 +19,12 @@
 #include <oboe/Oboe.h>
 
 #include "emulator.h"
+#include "scheduler.h"
 #include "snes9x.h"
 #include "gfx.h"
 #include "apu/apu.h"
 
+#include <atomic>
 #include <cstring>
 #include <string>
 #include <cmath>
@@ -117,6 +119,7 @@ static bool g_running   = false;
 static bool g_has_focus = false;
 static bool g_rewinding = false;
 static bool g_paused    = false;
+static bool g_audio_clock = false;  // audio_clock: AudioScheduler runs the core on its own thread
 
 // EGL state
 static EGLDisplay g_egl_display = EGL_NO_DISPLAY;
@@ -126,6 +129,8 @@ static ANativeWindow *g_native_window = nullptr;  // Saved for EGL recreation
 
 // GL state
 static GLuint g_texture       = 0;
+static bool   g_texture_stale = true;   // texture contents lost; next upload is a full one
+static GLuint g_rows_texture  = 0;      // per-row width flags for native_line_width frames
 static GLuint g_program       = 0;
 static GLuint g_vao           = 0;
 static GLuint g_color_program = 0;  // For overlays
@@ -138,6 +143,7 @@ static FrameThrottle g_frame_throttle;
 // Frame timing diagnostics
 static int g_frame_count = 0;
 static int g_late_frame_count = 0;
+static std::atomic<int> g_audio_underruns{0};  // Vsync mode: callbacks S9xMixSamples couldn't fill
 
 // ---------------------------------------------------------------------------
 // OpenGL ES shaders
@@ -167,8 +173,13 @@ precision mediump float;
 in vec2 vTexCoord;
 out vec4 fragColor;
 uniform sampler2D uTexture;
+uniform sampler2D uNarrowRows;  // 1.0 for rows drawn 256 wide in a 512-wide frame
+uniform bool uMixedWidths;
 void main() {
-    fragColor = texture(uTexture, vTexCoord);
+    vec2 tc = vTexCoord;
+    if (uMixedWidths)
+        tc.x *= 1.0 - 0.5 * texture(uNarrowRows, vec2(0.5, tc.y)).r;
+    fragColor = texture(uTexture, tc);
 }
 )";
 
@@ -271,6 +282,17 @@ static bool InitGL()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB565, MAX_SNES_WIDTH, MAX_SNES_HEIGHT,
                  0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, nullptr);
+    g_texture_stale = true;
+
+    // One texel per row: set for rows drawn at 256 pixels in a 512-wide frame
+    glGenTextures(1, &g_rows_texture);
+    glBindTexture(GL_TEXTURE_2D, g_rows_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, 1, MAX_SNES_HEIGHT,
+                 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -281,6 +303,7 @@ static bool InitGL()
 static void TeardownGL()
 {
     if (g_texture)       { glDeleteTextures(1, &g_texture); g_texture = 0; }
+    if (g_rows_texture)  { glDeleteTextures(1, &g_rows_texture); g_rows_texture = 0; }
     if (g_vao)           { glDeleteVertexArrays(1, &g_vao); g_vao = 0; }
     if (g_color_vbo)     { glDeleteBuffers(1, &g_color_vbo); g_color_vbo = 0; }
     if (g_program)       { glDeleteProgram(g_program); g_program = 0; }
@@ -488,21 +511,100 @@ static void DrawRewindBar()
 // Rendering
 // ---------------------------------------------------------------------------
 
+// The frame to draw: the core's own frame buffer, or with audio_clock the
+// newest frame from the scheduler's mailbox. When the scheduler has nothing
+// new, the previous frame is kept (it stays valid until the next acquire)
+// and only re-uploaded if the texture was lost.
+static struct ShownFrame {
+    const uint16_t *pixels = nullptr;
+    int width  = 0;
+    int height = 0;
+    const uint16_t *line_widths = nullptr;
+    uint32_t dirty[Emulator::DirtyRowWords] = {};
+    bool changed = false;
+} g_shown;
+
+static void TakeFrame()
+{
+    if (!g_audio_clock) {
+        g_shown.pixels      = Emulator::GetFrameBuffer();
+        g_shown.width       = Emulator::GetFrameWidth();
+        g_shown.height      = Emulator::GetFrameHeight();
+        g_shown.line_widths = Emulator::GetLineWidths();
+        g_shown.changed     = Emulator::GetDirtyRows(g_shown.dirty);
+        return;
+    }
+
+    const AudioScheduler::Frame *f = AudioScheduler::AcquireFrame();
+    if (!f) {
+        g_shown.changed = false;
+        return;
+    }
+    g_shown.pixels      = f->pixels;
+    g_shown.width       = f->width;
+    g_shown.height      = f->height;
+    g_shown.line_widths = f->line_widths;
+    memcpy(g_shown.dirty, f->dirty, sizeof(g_shown.dirty));
+    g_shown.changed     = true;
+    // Frames were dropped in between: their dirty rows are missing
+    if (f->full_upload)
+        g_texture_stale = true;
+}
+
+static void LogSchedulerStats()
+{
+    AudioScheduler::Stats s = AudioScheduler::GetStats();
+    LOGI("Audio clock: %llu emulated (%.2f ms each), %llu shown, %llu dropped, %llu repeated; "
+         "%llu underruns (%llu samples); queue %.1f ms; latency %.1f ms (max %.1f)",
+         (unsigned long long)s.frames_emulated, s.emulate_ms,
+         (unsigned long long)s.frames_shown, (unsigned long long)s.frames_dropped,
+         (unsigned long long)s.frames_repeated, (unsigned long long)s.audio_underruns,
+         (unsigned long long)s.underrun_frames, s.audio_queue_ms, s.latency_ms, s.latency_max_ms);
+}
+
 static void RenderFrame()
 {
     if (g_egl_display == EGL_NO_DISPLAY) return;
 
-    int w = Emulator::GetFrameWidth();
-    int h = Emulator::GetFrameHeight();
-    const uint16_t *fb = Emulator::GetFrameBuffer();
+    TakeFrame();
+    int w = g_shown.width;
+    int h = g_shown.height;
+    const uint16_t *fb = g_shown.pixels;
 
-    if (fb && w > 0 && h > 0) {
+    // Upload only the runs of rows that changed since the last upload
+    const uint32_t *dirty = g_shown.dirty;
+    bool changed = g_shown.changed;
+
+    if (fb && w > 0 && h > 0 && (changed || g_texture_stale)) {
         glBindTexture(GL_TEXTURE_2D, g_texture);
         // Framebuffer pitch is MAX_SNES_WIDTH, not the actual frame width
         glPixelStorei(GL_UNPACK_ROW_LENGTH, MAX_SNES_WIDTH);
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h,
-                        GL_RGB, GL_UNSIGNED_SHORT_5_6_5, fb);
+        for (int y = 0; y < h; ) {
+            if (!g_texture_stale && !(dirty[y >> 5] & (1u << (y & 31)))) {
+                y++;
+                continue;
+            }
+            int y0 = y;
+            while (y < h && (g_texture_stale || (dirty[y >> 5] & (1u << (y & 31)))))
+                y++;
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, w, y - y0,
+                            GL_RGB, GL_UNSIGNED_SHORT_5_6_5, fb + y0 * MAX_SNES_WIDTH);
+        }
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        g_texture_stale = false;
+    }
+
+    // A native_line_width frame with both 256- and 512-pixel rows: the
+    // shader halves the horizontal texture coordinate on the narrow ones
+    const uint16_t *widths = g_shown.line_widths;
+    if (fb && widths) {
+        uint8_t narrow[MAX_SNES_HEIGHT];
+        for (int y = 0; y < h; y++)
+            narrow[y] = widths[y] < w ? 255 : 0;
+        glBindTexture(GL_TEXTURE_2D, g_rows_texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, h, GL_RED, GL_UNSIGNED_BYTE, narrow);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     }
 
     // Calculate viewport for 4:3 aspect ratio
@@ -533,6 +635,12 @@ static void RenderFrame()
     glBindTexture(GL_TEXTURE_2D, g_texture);
     glUniform1i(glGetUniformLocation(g_program, "uTexture"), 0);
 
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, g_rows_texture);
+    glUniform1i(glGetUniformLocation(g_program, "uNarrowRows"), 1);
+    glUniform1i(glGetUniformLocation(g_program, "uMixedWidths"), widths != nullptr);
+    glActiveTexture(GL_TEXTURE0);
+
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
     // Draw overlays on top of full screen (reset viewport first)
@@ -548,6 +656,15 @@ static void RenderFrame()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(g_vao);
 
+    // With audio_clock the emulation thread keeps the game's pace and the
+    // swap only waits for vsync
+    if (g_audio_clock) {
+        if (++g_frame_count % 1800 == 0)
+            LogSchedulerStats();
+        eglSwapBuffers(g_egl_display, g_egl_surface);
+        return;
+    }
+
     // Pace frame rate before swap. We target the SNES frame rate (~60.1Hz NTSC,
     // ~50.0Hz PAL) rather than the display refresh rate. On a 60Hz display (assumed
     // for typical Android handhelds), eglSwapBuffers below will block at 60Hz while
@@ -570,7 +687,8 @@ static void RenderFrame()
         }
     } else if (g_frame_count % 1800 == 0) {
         // Log status every ~30 seconds when running smoothly
-        LOGI("Frame timing: on schedule (%d frames, %d late)", g_frame_count, g_late_frame_count);
+        LOGI("Frame timing: on schedule (%d frames, %d late, %d audio underruns)",
+             g_frame_count, g_late_frame_count, g_audio_underruns.load());
     }
 
     eglSwapBuffers(g_egl_display, g_egl_surface);
@@ -588,8 +706,13 @@ public:
             int32_t numFrames) override
     {
         (void)stream;
+        if (g_audio_clock) {
+            AudioScheduler::MixSamples((int16_t *)audioData, numFrames);
+            return oboe::DataCallbackResult::Continue;
+        }
         // numFrames = stereo frame count; S9xMixSamples wants sample count (frames * 2)
-        S9xMixSamples((uint8 *)audioData, numFrames * 2);
+        if (!S9xMixSamples((uint8 *)audioData, numFrames * 2) && !g_paused)
+            g_audio_underruns++;
         return oboe::DataCallbackResult::Continue;
     }
 };
@@ -640,6 +763,14 @@ static void StopAudio()
 
 static uint16_t g_pad_buttons = 0;
 
+static void SetPadButtons()
+{
+    if (g_audio_clock)
+        AudioScheduler::SetButtonState(0, g_pad_buttons);
+    else
+        Emulator::SetButtonState(0, g_pad_buttons);
+}
+
 // Touch gesture tracking for pause (two-finger tap) and rewind (two-finger swipe)
 static struct TouchState {
     int activePointerCount = 0;
@@ -653,8 +784,24 @@ static struct TouchState {
     bool rewinding = false;
 } g_touch;
 
+// Set while PollInput() drains events from inside RunFrame(). Rewinding
+// loads a state, so a rewind request seen then waits for the frame to end.
+static bool g_polling_in_frame = false;
+static int  g_deferred_rewind  = -1;
+
 static void UpdateRewindState(bool rewindRequested)
 {
+    if (g_audio_clock) {
+        g_rewinding = rewindRequested;
+        AudioScheduler::SetRewinding(rewindRequested);
+        return;
+    }
+
+    if (g_polling_in_frame) {
+        g_deferred_rewind = rewindRequested;
+        return;
+    }
+
     if (rewindRequested && !Emulator::IsRewinding()) {
         g_rewinding = true;
         Emulator::RewindStartContinuous();
@@ -704,7 +851,7 @@ static int32_t HandleInputEvent(struct android_app *app, AInputEvent *event)
         else
             g_pad_buttons &= ~mask;
 
-        Emulator::SetButtonState(0, g_pad_buttons);
+        SetPadButtons();
         return 1;
     }
 
@@ -878,13 +1025,26 @@ static int32_t HandleInputEvent(struct android_app *app, AInputEvent *event)
         float l2 = AMotionEvent_getAxisValue(event, AMOTION_EVENT_AXIS_LTRIGGER, 0);
         UpdateRewindState(l2 > 0.5f);
 
-        Emulator::SetButtonState(0, g_pad_buttons);
+        SetPadButtons();
         return 1;
     }
 
     return 0;
 }
 
+// Called by the core when the game reads the joypads, partway through
+// RunFrame(): handle the input events that arrived since the main loop polled.
+static void PollInput(void *userdata)
+{
+    struct android_app *app = (struct android_app *)userdata;
+    if (!app->inputQueue)
+        return;
+
+    g_polling_in_frame = true;
+    app->inputPollSource.process(app, &app->inputPollSource);
+    g_polling_in_frame = false;
+}
+
 // ---------------------------------------------------------------------------
 // ROM path extraction via JNI
 // ---------------------------------------------------------------------------
@@ -962,13 +1122,23 @@ static std::string GetRomPathFromIntent(struct android_app *app)
 // JNI functions for lifecycle control from Kotlin side
 // ---------------------------------------------------------------------------
 
+// The scheduler's thread owns the core while it runs, so it is stopped
+// around every Suspend(), Resume() and Shutdown() below.
+static void StartScheduler()
+{
+    if (g_audio_clock && g_running)
+        AudioScheduler::Start();
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_ezsnes9x_emulator_EmulatorActivity_nativeSuspend(JNIEnv *env, jobject thiz) {
     (void)env; (void)thiz;
     LOGI("Lifecycle: onPause - suspending emulation");
     if (g_running && !g_paused) {
+        AudioScheduler::Stop();
         Emulator::Suspend();
         StopAudio();
+        LOGI("Suspend state captured in %.1f ms", Emulator::GetSuspendTimings().capture_ms);
     }
 }
 
@@ -977,8 +1147,13 @@ Java_com_ezsnes9x_emulator_EmulatorActivity_nativeResume(JNIEnv *env, jobject th
     (void)env; (void)thiz;
     LOGI("Lifecycle: onResume - resuming emulation");
     if (g_running && !g_paused) {
+        AudioScheduler::Stop();
         StartAudio();
         Emulator::Resume();
+        StartScheduler();
+        Emulator::SuspendTimings t = Emulator::GetSuspendTimings();
+        LOGI("Suspend: capture %.1f ms, pack+write %.1f ms (%u -> %u bytes), resume %.1f ms",
+             t.capture_ms, t.write_ms, t.state_bytes, t.file_bytes, t.resume_ms);
     }
 }
 
@@ -1022,18 +1197,24 @@ static void HandleAppCmd(struct android_app *app, int32_t cmd)
 
         case APP_CMD_GAINED_FOCUS:
             g_has_focus = true;
-            if (g_running && !g_paused)
+            if (g_running && !g_paused) {
+                AudioScheduler::Stop();
                 Emulator::Resume();
+                StartScheduler();
+            }
             break;
 
         case APP_CMD_LOST_FOCUS:
             g_has_focus = false;
-            if (g_running && !g_paused)
+            if (g_running && !g_paused) {
+                AudioScheduler::Stop();
                 Emulator::Suspend();
+            }
             break;
 
         case APP_CMD_DESTROY:
             if (g_running) {
+                AudioScheduler::Stop();
                 // Save suspend state before quitting (even if app didn't lose focus first)
                 if (!g_paused)
                     Emulator::Suspend();
@@ -1100,9 +1281,16 @@ void android_main(struct android_app *app)
         : NTSC_PROGRESSIVE_FRAME_RATE);
     g_frame_throttle.reset();
 
+    // Sample the gamepad when the game reads it, not just once per frame.
+    // The audio-clocked scheduler applies input on its own thread instead.
+    g_audio_clock = Emulator::GetConfig()->audio_clock;
+    if (!g_audio_clock)
+        Emulator::SetInputPollCallback(PollInput, app);
+
     // Start audio
     StartAudio();
     g_running = true;
+    StartScheduler();
 
     // Main loop
     while (!app->destroyRequested) {
@@ -1116,12 +1304,19 @@ void android_main(struct android_app *app)
 
         if (g_running && g_has_focus && g_egl_display != EGL_NO_DISPLAY) {
             // Run one frame (skip if paused)
-            if (!g_paused) {
+            if (g_audio_clock) {
+                AudioScheduler::SetPaused(g_paused);
+            } else if (!g_paused) {
                 if (Emulator::IsRewinding()) {
                     Emulator::RewindTick();
                 } else {
                     Emulator::RunFrame();
                 }
+
+                if (g_deferred_rewind >= 0) {
+                    UpdateRewindState(g_deferred_rewind != 0);
+                    g_deferred_rewind = -1;
+                }
             }
 
             RenderFrame();
@@ -1129,6 +1324,8 @@ void android_main(struct android_app *app)
     }
 
     // Cleanup
+    AudioScheduler::Stop();
+    Emulator::SetInputPollCallback(nullptr, nullptr);
     StopAudio();
     if (g_running) {
         Emulator::Shutdown();
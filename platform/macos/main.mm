@@ -61,10 +61,21 @@ vertex VertexOut vertexShader(uint vid [[vertex_id]],
     return out;
 }
 
+// For native_line_width frames that mix 256- and 512-pixel rows, one flag
+// per texture row (478 = MAX_SNES_HEIGHT): set for rows drawn 256 wide
+struct NarrowRows {
+    uint mixed;
+    uchar narrow[478];
+};
+
 fragment float4 fragmentShader(VertexOut in [[stage_in]],
                                texture2d<float> tex [[texture(0)]],
-                               sampler samp [[sampler(0)]]) {
-    return tex.sample(samp, in.texCoord);
+                               sampler samp [[sampler(0)]],
+                               constant NarrowRows &rows [[buffer(0)]]) {
+    float2 tc = in.texCoord;
+    if (rows.mixed && rows.narrow[min(uint(tc.y * 478.0), 477u)])
+        tc.x *= 0.5;
+    return tex.sample(samp, tc);
 }
 
 // Overlay shader for solid color rectangles
@@ -176,17 +187,46 @@ static void UpdateRewindState(bool rewindRequested) {
 // InputManager — GCController mapping to SNES joypad bitmask
 // ---------------------------------------------------------------------------
 
+static uint16_t ButtonsFromGamepad(GCExtendedGamepad *gamepad) {
+    uint16_t buttons = 0;
+
+    if (gamepad.dpad.up.pressed)      buttons |= SNES_UP_MASK;
+    if (gamepad.dpad.down.pressed)    buttons |= SNES_DOWN_MASK;
+    if (gamepad.dpad.left.pressed)    buttons |= SNES_LEFT_MASK;
+    if (gamepad.dpad.right.pressed)   buttons |= SNES_RIGHT_MASK;
+
+    // Map face buttons: SNES layout
+    // GC A (right) -> SNES A, GC B (bottom) -> SNES B
+    // GC X (top)   -> SNES X, GC Y (left)   -> SNES Y
+    if (gamepad.buttonA.pressed)      buttons |= SNES_A_MASK;
+    if (gamepad.buttonB.pressed)      buttons |= SNES_B_MASK;
+    if (gamepad.buttonX.pressed)      buttons |= SNES_X_MASK;
+    if (gamepad.buttonY.pressed)      buttons |= SNES_Y_MASK;
+
+    if (gamepad.leftShoulder.pressed)  buttons |= SNES_TL_MASK;
+    if (gamepad.rightShoulder.pressed) buttons |= SNES_TR_MASK;
+
+    // Menu button -> Start, Options button -> Select
+    if (gamepad.buttonMenu.pressed)    buttons |= SNES_START_MASK;
+    if (gamepad.buttonOptions && gamepad.buttonOptions.pressed)
+        buttons |= SNES_SELECT_MASK;
+
+    return buttons;
+}
+
 @interface InputManager : NSObject {
     BOOL portUsed[8]; // Track which ports are assigned
 }
 @property (nonatomic, strong) NSMutableArray<GCController *> *controllers;
 @property (nonatomic, assign) int nextAutoPort; // Next available port for auto-assignment
 @property (nonatomic, strong) NSMutableDictionary<NSNumber *, NSString *> *portNames; // port -> device name
+@property (nonatomic, strong) NSMutableDictionary<NSNumber *, GCController *> *portControllers; // port -> gamepad
 - (void)setup;
 - (void)teardown;
 - (int)assignPortForController:(GCController *)controller;
 - (BOOL)isPortUsed:(int)port;
 - (void)setPortUsed:(int)port used:(BOOL)used;
+- (void)pollControllers;
 @end
 
 @implementation InputManager
@@ -203,6 +243,7 @@ static void UpdateRewindState(bool rewindRequested) {
 - (void)setup {
     self.controllers = [NSMutableArray array];
     self.portNames = [NSMutableDictionary dictionary];
+    self.portControllers = [NSMutableDictionary dictionary];
     self.nextAutoPort = 0;
     for (int i = 0; i < 8; i++)
         portUsed[i] = NO;
@@ -249,6 +290,19 @@ static void UpdateRewindState(bool rewindRequested) {
     printf("[Input] Controller DISCONNECTED: %s\n",
            c.vendorName ? c.vendorName.UTF8String : "unknown");
     [self.controllers removeObject:c];
+    for (NSNumber *port in [self.portControllers allKeysForObject:c])
+        [self.portControllers removeObjectForKey:port];
+}
+
+// The change handlers only run between frames, on the main queue. The core
+// calls this from inside RunFrame() when the game reads the joypads, so read
+// the gamepads' current state directly.
+- (void)pollControllers {
+    for (NSNumber *port in self.portControllers) {
+        GCExtendedGamepad *gp = self.portControllers[port].extendedGamepad;
+        if (gp)
+            Emulator::SetButtonState(port.intValue, ButtonsFromGamepad(gp));
+    }
 }
 
 - (int)assignPortForController:(GCController *)controller {
@@ -307,30 +361,11 @@ static void UpdateRewindState(bool rewindRequested) {
     GCExtendedGamepad *gp = controller.extendedGamepad;
     if (!gp) return;
 
+    self.portControllers[@(padIndex)] = controller;
+
     gp.valueChangedHandler = ^(GCExtendedGamepad *gamepad, GCControllerElement *element) {
         (void)element;
-        uint16_t buttons = 0;
-
-        if (gamepad.dpad.up.pressed)      buttons |= SNES_UP_MASK;
-        if (gamepad.dpad.down.pressed)    buttons |= SNES_DOWN_MASK;
-        if (gamepad.dpad.left.pressed)    buttons |= SNES_LEFT_MASK;
-        if (gamepad.dpad.right.pressed)   buttons |= SNES_RIGHT_MASK;
-
-        // Map face buttons: SNES layout
-        // GC A (right) -> SNES A, GC B (bottom) -> SNES B
-        // GC X (top)   -> SNES X, GC Y (left)   -> SNES Y
-        if (gamepad.buttonA.pressed)      buttons |= SNES_A_MASK;
-        if (gamepad.buttonB.pressed)      buttons |= SNES_B_MASK;
-        if (gamepad.buttonX.pressed)      buttons |= SNES_X_MASK;
-        if (gamepad.buttonY.pressed)      buttons |= SNES_Y_MASK;
-
-        if (gamepad.leftShoulder.pressed)  buttons |= SNES_TL_MASK;
-        if (gamepad.rightShoulder.pressed) buttons |= SNES_TR_MASK;
-
-        // Menu button -> Start, Options button -> Select
-        if (gamepad.buttonMenu.pressed)    buttons |= SNES_START_MASK;
-        if (gamepad.buttonOptions && gamepad.buttonOptions.pressed)
-            buttons |= SNES_SELECT_MASK;
+        uint16_t buttons = ButtonsFromGamepad(gamepad);
 
         if (g_debug)
             printf("[Input] Controller pad%d buttons=0x%04x\n", padIndex, buttons);
@@ -343,6 +378,10 @@ static void UpdateRewindState(bool rewindRequested) {
 
 @end
 
+static void PollInput(void *userdata) {
+    [(__bridge InputManager *)userdata pollControllers];
+}
+
 // ---------------------------------------------------------------------------
 // GameView — MTKView subclass that accepts first responder for keyboard input
 // ---------------------------------------------------------------------------
@@ -454,6 +493,7 @@ static void HandleKeyEvent(NSEvent *event, BOOL pressed) {
 @property (nonatomic, strong) id<MTLRenderPipelineState> colorPipelineState;
 @property (nonatomic, strong) id<MTLCommandQueue> commandQueue;
 @property (nonatomic, strong) id<MTLTexture> texture;
+@property (nonatomic, assign) BOOL textureStale;   // texture never filled; next upload is a full one
 @property (nonatomic, strong) id<MTLSamplerState> sampler;
 @end
 
@@ -528,6 +568,7 @@ static void HandleKeyEvent(NSEvent *event, BOOL pressed) {
                                  mipmapped:NO];
     texDesc.usage = MTLTextureUsageShaderRead;
     self.texture = [self.device newTextureWithDescriptor:texDesc];
+    self.textureStale = YES;
 
     // Nearest-neighbor sampler for crisp pixels
     MTLSamplerDescriptor *sampDesc = [[MTLSamplerDescriptor alloc] init];
@@ -559,26 +600,40 @@ static void HandleKeyEvent(NSEvent *event, BOOL pressed) {
     int h = Emulator::GetFrameHeight();
     const uint16_t *fb = Emulator::GetFrameBuffer();
 
-    if (fb && w > 0 && h > 0) {
-        // Convert RGB555 to BGRA8
+    // Convert and upload only the runs of rows that changed since the last upload
+    uint32_t dirty[Emulator::DirtyRowWords];
+    bool changed = Emulator::GetDirtyRows(dirty);
+    const uint16_t *widths = Emulator::GetLineWidths();  // non-null: some rows are 256 of w wide
+
+    if (fb && w > 0 && h > 0 && (changed || self.textureStale)) {
         static uint32_t convertedBuffer[MAX_SNES_WIDTH * MAX_SNES_HEIGHT];
-        for (int y = 0; y < h; y++) {
-            for (int x = 0; x < w; x++) {
-                uint16_t rgb555 = fb[y * MAX_SNES_WIDTH + x];
-                // Extract RGB555: 0RRRRRGGGGGBBBBB
-                uint8_t r = ((rgb555 >> 10) & 0x1F) << 3; // 5->8 bit
-                uint8_t g = ((rgb555 >> 5) & 0x1F) << 3;
-                uint8_t b = (rgb555 & 0x1F) << 3;
-                // Pack as BGRA8
-                convertedBuffer[y * MAX_SNES_WIDTH + x] = (0xFF << 24) | (r << 16) | (g << 8) | b;
+        BOOL all = self.textureStale;
+        for (int y = 0; y < h; ) {
+            if (!all && !(dirty[y >> 5] & (1u << (y & 31)))) {
+                y++;
+                continue;
+            }
+            int y0 = y;
+            for (; y < h && (all || (dirty[y >> 5] & (1u << (y & 31)))); y++) {
+                int rowWidth = widths ? widths[y] : w;
+                for (int x = 0; x < rowWidth; x++) {
+                    uint16_t rgb555 = fb[y * MAX_SNES_WIDTH + x];
+                    // Extract RGB555: 0RRRRRGGGGGBBBBB
+                    uint8_t r = ((rgb555 >> 10) & 0x1F) << 3; // 5->8 bit
+                    uint8_t g = ((rgb555 >> 5) & 0x1F) << 3;
+                    uint8_t b = (rgb555 & 0x1F) << 3;
+                    // Pack as BGRA8
+                    convertedBuffer[y * MAX_SNES_WIDTH + x] = (0xFF << 24) | (r << 16) | (g << 8) | b;
+                }
             }
-        }
 
-        MTLRegion region = MTLRegionMake2D(0, 0, w, h);
-        [self.texture replaceRegion:region
-                        mipmapLevel:0
-                          withBytes:convertedBuffer
-                        bytesPerRow:MAX_SNES_WIDTH * sizeof(uint32_t)];
+            MTLRegion region = MTLRegionMake2D(0, y0, w, y - y0);
+            [self.texture replaceRegion:region
+                            mipmapLevel:0
+                              withBytes:convertedBuffer + y0 * MAX_SNES_WIDTH
+                            bytesPerRow:MAX_SNES_WIDTH * sizeof(uint32_t)];
+        }
+        self.textureStale = NO;
     }
 
     // Render
@@ -616,6 +671,14 @@ static void HandleKeyEvent(NSEvent *event, BOOL pressed) {
     texScale.scaleY = (float)h / (float)MAX_SNES_HEIGHT;
     [enc setVertexBytes:&texScale length:sizeof(texScale) atIndex:0];
 
+    // Rows drawn 256 wide in a 512-wide native_line_width frame
+    struct { uint32_t mixed; uint8_t narrow[MAX_SNES_HEIGHT]; } narrowRows;
+    static_assert(MAX_SNES_HEIGHT == 478, "update NarrowRows in kShaderSource");
+    narrowRows.mixed = widths != nullptr;
+    for (int y = 0; y < MAX_SNES_HEIGHT; y++)
+        narrowRows.narrow[y] = widths && y < h && widths[y] < w;
+    [enc setFragmentBytes:&narrowRows length:sizeof(narrowRows) atIndex:0];
+
     [enc drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:6];
 
     // Draw rewind progress bar overlay if rewinding
@@ -843,6 +906,7 @@ static void HandleKeyEvent(NSEvent *event, BOOL pressed) {
     // Set up input
     self.input = [[InputManager alloc] init];
     [self.input setup];
+    Emulator::SetInputPollCallback(PollInput, (__bridge void *)self.input);
 
     // Wait for controller discovery (GCController discovery can be delayed)
     // Give it 100ms to discover already-connected controllers
@@ -897,6 +961,7 @@ static void HandleKeyEvent(NSEvent *event, BOOL pressed) {
         Emulator::Suspend();
     g_running = false;
     [self.audio stop];
+    Emulator::SetInputPollCallback(nullptr, nullptr);
     [self.input teardown];
     Emulator::Shutdown();
 }
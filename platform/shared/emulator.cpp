@@ -14,13 +14,18 @@
 #include "controls.h"
 #include "config.h"
 #include "rewind.h"
+#include "savewriter.h"
+#include "inputlog.h"
+#include "lz.h"
 #include "cpuexec.h"
 #include "stream.h"
 #include "fscompat.h"
 
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <vector>
 #include <sys/stat.h>
 
 // ---------------------------------------------------------------------------
@@ -30,9 +35,22 @@
 static S9xConfig s_config;
 static std::string s_save_dir;
 static std::string s_suspend_path;
+static std::string s_input_log_path;  // record_input: <rom>.inputlog next to the suspend file
+static bool s_input_record_pending = false;  // record_input: start a log at the next RunFrame()
 static int s_frame_width  = 256;
 static int s_frame_height = 224;
 static bool s_rewinding = false;
+static std::vector<uint8_t> s_suspend_state;  // Suspend() freezes here, then hands it to the writer
+static uint32_t s_suspend_size = 0;
+static Emulator::SuspendTimings s_suspend_timings;
+static uint64_t s_frame_cycles = 0;  // Master cycles of the frames run since LoadROM()
+static Emulator::InputPollCallback s_poll_callback = nullptr;
+static void *s_poll_data = nullptr;
+
+static double ms_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
 static bool file_exists(const char *path)
 {
@@ -40,6 +58,69 @@ static bool file_exists(const char *path)
     return stat(path, &st) == 0;
 }
 
+// Print how much of the game's CPU and SPC700 time idle-loop skipping saved,
+// then start counting afresh.
+static void report_idle_loops()
+{
+    uint64 apu_skipped, apu_cycles;
+    S9xAPUGetIdleLoopStats(&apu_skipped, &apu_cycles);
+
+    if (s_frame_cycles && (IdleLoop.Skips || apu_skipped))
+    {
+        char msg[200];
+        snprintf(msg, sizeof(msg), "Idle loops: skipped %.1f%% of CPU time (%.1f%% in loops, %.1f%% in WAI, %u skips), %.1f%% of SPC700 time",
+                 100.0 * (IdleLoop.LoopCycles + IdleLoop.WaitCycles) / s_frame_cycles,
+                 100.0 * IdleLoop.LoopCycles / s_frame_cycles,
+                 100.0 * IdleLoop.WaitCycles / s_frame_cycles, IdleLoop.Skips,
+                 apu_cycles ? 100.0 * apu_skipped / apu_cycles : 0.0);
+        S9xMessage(S9X_INFO, S9X_ROM_INFO, msg);
+    }
+
+    S9xAPUResetIdleLoopStats();
+    s_frame_cycles = 0;
+    IdleLoop.Skips = 0;
+    IdleLoop.LoopCycles = 0;
+    IdleLoop.WaitCycles = 0;
+}
+
+// The core has one joypad poll hook: the frontend's callback, then the input
+// log, which records what the game is about to read or replaces it. During a
+// replay the frontend isn't asked at all.
+static void input_poll(void *)
+{
+    if (s_poll_callback && !InputLogReplaying())
+        s_poll_callback(s_poll_data);
+    InputLogPoll();
+}
+
+static void update_poll_callback()
+{
+    if (s_poll_callback || InputLogActive())
+        S9xSetJoypadPollCallback(input_poll, nullptr);
+    else
+        S9xSetJoypadPollCallback(nullptr, nullptr);
+}
+
+// record_input: start a new log from the state the game is in now (just
+// reset, or just loaded from or written to the suspend file). Each one
+// replaces the last log that recorded any frames. The snapshot is taken at
+// the next RunFrame(), so Suspend() doesn't pay for a second freeze, and a
+// Suspend() followed by Resume() with no frame in between costs nothing.
+static void start_input_record()
+{
+    s_input_record_pending = s_config.record_input;
+}
+
+static void begin_pending_input_record()
+{
+    if (!s_input_record_pending || s_rewinding)
+        return;
+
+    s_input_record_pending = false;
+    if (!InputLogActive())
+        Emulator::InputRecordStart(s_input_log_path.c_str(), true);
+}
+
 // ---------------------------------------------------------------------------
 // Emulator namespace implementation
 // ---------------------------------------------------------------------------
@@ -71,13 +152,23 @@ bool Init(const char *config_path)
     S9xSetController(0, CTL_JOYPAD, 0);
     S9xSetController(1, CTL_JOYPAD, 1);
 
-    // Load config if provided
+    // Load config if provided; one that was asked for but can't be read is
+    // an error, not a silent run with the defaults
     if (config_path && config_path[0])
     {
-        S9xLoadConfig(config_path, s_config);
+        if (!S9xLoadConfig(config_path, s_config))
+        {
+            std::string msg = std::string("Can't read config file ") + config_path;
+            S9xMessage(S9X_ERROR, S9X_CONFIG_INFO, msg.c_str());
+            return false;
+        }
         if (!s_config.save_dir.empty())
             s_save_dir = s_config.save_dir;
     }
+    Settings.FastDSP = s_config.fast_dsp;
+    Settings.DeferredRendering = s_config.deferred_render;
+    Settings.NativeLineWidth = s_config.native_line_width;
+    Settings.IdleLoopSkip = s_config.idle_loop_skip;
 
     if (!Memory.Init())
         return false;
@@ -104,18 +195,25 @@ bool Init(const char *config_path)
 
 bool LoadROM(const char *rom_path)
 {
+    report_idle_loops();
+    InputLogStop();
+    s_input_record_pending = false;
+
     if (!Memory.LoadROM(rom_path))
         return false;
 
-    // Determine save directory
-    if (s_save_dir.empty())
-    {
-        auto path = splitpath(Memory.ROMFilename);
-        s_save_dir = path.dir;
-    }
+    // Determine save directory: the configured one, else next to this ROM
+    // (not the previous one, when several are loaded after one Init())
+    if (!s_config.save_dir.empty())
+        s_save_dir = s_config.save_dir;
+    else
+        s_save_dir = splitpath(Memory.ROMFilename).dir;
 
     // Set suspend state path
     s_suspend_path = s_save_dir + SLASH_STR + S9xBasenameNoExt(Memory.ROMFilename) + ".suspend";
+    s_input_log_path = s_save_dir + SLASH_STR + S9xBasenameNoExt(Memory.ROMFilename) + ".inputlog";
+    s_suspend_state.clear();
+    s_suspend_size = 0;
 
     // Load SRAM if it exists
     std::string sram_path = S9xGetFilename(".srm", SRAM_DIR);
@@ -130,12 +228,16 @@ bool LoadROM(const char *rom_path)
     if (s_config.rewind_enabled)
         RewindInit();
 
+    start_input_record();
     return true;
 }
 
 void RunFrame()
 {
+    begin_pending_input_record();
     S9xMainLoop();
+    s_frame_cycles += (uint64_t)Timings.H_Max_Master * Timings.V_Max;
+    InputLogEndFrame(s_frame_width, s_frame_height);
 
     if (!s_rewinding)
         RewindCapture();
@@ -143,11 +245,14 @@ void RunFrame()
 
 void Shutdown()
 {
+    InputLogStop();
     Settings.StopEmulation = true;
 
-    // Save SRAM
+    // Save SRAM, and wait for it and any earlier autosave to reach disk
     std::string sram_path = S9xGetFilename(".srm", SRAM_DIR);
     Memory.SaveSRAM(sram_path.c_str());
+    SaveWriterDeinit();
+    report_idle_loops();
 
     RewindDeinit();
     S9xGraphicsDeinit();
@@ -156,6 +261,10 @@ void Shutdown()
 
     s_save_dir.clear();
     s_suspend_path.clear();
+    s_input_log_path.clear();
+    s_input_record_pending = false;
+    s_suspend_state.clear();
+    s_suspend_size = 0;
     s_rewinding = false;
 }
 
@@ -165,6 +274,8 @@ void RewindStartContinuous()
 {
     if (s_rewinding)
         return; // Already rewinding
+    if (InputLogActive())
+        return; // Would break the recording or replay
 
     s_rewinding = true;
     Settings.Rewinding = true;
@@ -223,10 +334,29 @@ void Suspend()
     if (Settings.StopEmulation)
         return;
 
-    S9xFreezeGame(s_suspend_path.c_str());
+    // Freeze into memory and let the save writer compress and write it, so
+    // the caller (onPause on Android) only waits for the freeze itself.
+    auto start = std::chrono::steady_clock::now();
+
+    if (!s_suspend_size)
+        s_suspend_size = S9xFreezeSize();
+    s_suspend_state.resize(s_suspend_size);
+    S9xFreezeGameMem(s_suspend_state.data(), s_suspend_size);
+    SaveWriterQueue(s_suspend_path, s_suspend_state, true);
 
     std::string sram_path = S9xGetFilename(".srm", SRAM_DIR);
     Memory.SaveSRAM(sram_path.c_str());
+
+    s_suspend_timings.capture_ms  = ms_since(start);
+    s_suspend_timings.state_bytes = s_suspend_size;
+
+    // Write out the session's input log (its snapshot was packed when it
+    // started); the next one starts from the state just suspended
+    if (s_config.record_input && GetInputLogStatus().recording)
+    {
+        InputLogStop();
+        start_input_record();
+    }
 }
 
 void Resume()
@@ -234,17 +364,138 @@ void Resume()
     if (Settings.StopEmulation)
         return;
 
-    if (file_exists(s_suspend_path.c_str()))
+    // Loading a state ends any input log; then the last suspend may still
+    // be on its way to disk.
+    InputLogStop();
+    SaveWriterFlush();
+
+    double ms;
+    size_t bytes;
+    if (SaveWriterLastWrite(s_suspend_path, &ms, &bytes))
+    {
+        s_suspend_timings.write_ms   = ms;
+        s_suspend_timings.file_bytes = (uint32_t)bytes;
+    }
+
+    FILE *file = fopen(s_suspend_path.c_str(), "rb");
+    if (!file)
+    {
+        start_input_record();
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<uint8_t> data;
+    uint8_t chunk[65536];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        data.insert(data.end(), chunk, chunk + len);
+    fclose(file);
+
+    // Suspend files written before the save writer are plain snapshots.
+    std::vector<uint8_t> state;
+    if (!S9xIsPackedLZ(data.data(), data.size()))
         S9xUnfreezeGame(s_suspend_path.c_str());
+    else if (!S9xUnpackLZ(data.data(), data.size(), state) ||
+             S9xUnfreezeGameMem(state.data(), (uint32)state.size()) != SUCCESS)
+        S9xMessage(S9X_ERROR, S9X_WRONG_FORMAT, "Suspend state is damaged; starting from the last SRAM save.");
+
+    s_suspend_timings.resume_ms = ms_since(start);
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "Suspend: freeze %.1f ms, pack+write %.1f ms (%u -> %u bytes), resume %.1f ms",
+             s_suspend_timings.capture_ms, s_suspend_timings.write_ms,
+             s_suspend_timings.state_bytes, s_suspend_timings.file_bytes, s_suspend_timings.resume_ms);
+    S9xMessage(S9X_INFO, S9X_FREEZE_FILE_INFO, msg);
+
+    start_input_record();
+}
+
+SuspendTimings GetSuspendTimings()
+{
+    return s_suspend_timings;
+}
+
+IdleLoopStats GetIdleLoopStats()
+{
+    IdleLoopStats stats;
+    stats.total_cycles = s_frame_cycles;
+    stats.loop_cycles  = IdleLoop.LoopCycles;
+    stats.wait_cycles  = IdleLoop.WaitCycles;
+    stats.skips        = IdleLoop.Skips;
+
+    uint64 apu_skipped, apu_cycles;
+    S9xAPUGetIdleLoopStats(&apu_skipped, &apu_cycles);
+    stats.apu_cycles  = apu_cycles;
+    stats.apu_skipped = apu_skipped;
+    return stats;
 }
 
 // Input
 
 void SetButtonState(int pad, uint16_t buttons)
 {
+    if (InputLogReplaying())
+        return;
     S9xSetJoypadButtons(pad, (uint16)buttons);
 }
 
+void SetInputPollCallback(InputPollCallback callback, void *userdata)
+{
+    s_poll_callback = callback;
+    s_poll_data     = userdata;
+    update_poll_callback();
+}
+
+// Input log
+
+bool InputRecordStart(const char *path, bool frame_hashes)
+{
+    if (s_rewinding)
+        return false;
+
+    bool ok = InputLogRecord(path, frame_hashes);
+    update_poll_callback();
+    return ok;
+}
+
+bool InputReplayStart(const char *path)
+{
+    if (s_rewinding)
+        return false;
+
+    bool ok = InputLogReplay(path);
+    update_poll_callback();
+    return ok;
+}
+
+void InputLogStop()
+{
+    ::InputLogStop();
+    update_poll_callback();
+}
+
+InputLogStatus GetInputLogStatus()
+{
+    SInputLogStatus s;
+    InputLogGetStatus(&s);
+
+    InputLogStatus status;
+    status.recording          = s.recording;
+    status.replaying          = s.replaying;
+    status.finished           = s.finished;
+    status.frame              = s.frame;
+    status.frames             = s.frames;
+    status.hashes_checked     = s.hashes_checked;
+    status.state_mismatches   = s.state_mismatches;
+    status.picture_mismatches = s.picture_mismatches;
+    status.first_mismatch     = s.first_mismatch;
+    status.state_hash         = s.state_hash;
+    status.picture_hash       = s.picture_hash;
+    return status;
+}
+
 // Accessors
 
 const uint16_t *GetFrameBuffer()
@@ -252,6 +503,25 @@ const uint16_t *GetFrameBuffer()
     return (const uint16_t *)GFX.Screen;
 }
 
+bool GetDirtyRows(uint32_t rows[DirtyRowWords])
+{
+    const int words = sizeof(SGFX::DirtyRows) / sizeof(uint32);
+    static_assert(words <= DirtyRowWords, "DirtyRowWords doesn't cover MAX_SNES_HEIGHT");
+
+    uint32_t any = 0;
+    for (int i = 0; i < DirtyRowWords; i++) {
+        rows[i] = i < words ? GFX.DirtyRows[i] : 0;
+        any |= rows[i];
+    }
+    memset(GFX.DirtyRows, 0, sizeof(GFX.DirtyRows));
+    return any != 0;
+}
+
+const uint16_t *GetLineWidths()
+{
+    return GFX.MixedWidths ? (const uint16_t *)GFX.LineWidth : nullptr;
+}
+
 int GetFrameWidth()
 {
     return s_frame_width;
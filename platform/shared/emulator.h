@@ -12,7 +12,7 @@
 struct S9xConfig;
 
 namespace Emulator {
-    bool Init(const char *config_path);         // Load config, init memory/APU/graphics
+    bool Init(const char *config_path);         // Load config, init memory/APU/graphics (false if a given config can't be read)
     bool LoadROM(const char *rom_path);         // Load ROM, set up controllers, reset
     void RunFrame();                             // S9xMainLoop() + rewind capture
     void Shutdown();                             // Save SRAM, deinit everything
@@ -28,16 +28,83 @@ namespace Emulator {
     int GetRewindPosition();               // Current position (0 = oldest, depth-1 = newest)
 
     // Suspend/Resume (app lifecycle)
-    void Suspend();                        // Save state to temp file + save SRAM
-    void Resume();                         // Restore state from temp file
+    struct SuspendTimings {
+        double   capture_ms  = 0;          // Suspend(): freeze to memory, queue state + SRAM
+        double   write_ms    = 0;          // Background compress + write of the last suspend
+        double   resume_ms   = 0;          // Resume(): read, decompress, unfreeze
+        uint32_t state_bytes = 0;          // Uncompressed state size
+        uint32_t file_bytes  = 0;          // Size on disk
+    };
+    void Suspend();                        // Freeze to memory; state + SRAM are written in the background
+    void Resume();                         // Restore state from the suspend file (compressed or legacy)
+    SuspendTimings GetSuspendTimings();    // Timings of the last Suspend()/Resume()
+
+    // Idle-loop skipping (idle_loop_skip), since the current game was loaded
+    struct IdleLoopStats {
+        uint64_t total_cycles = 0;         // Master cycles emulated (whole frames)
+        uint64_t loop_cycles  = 0;         // Skipped in polling loops
+        uint64_t wait_cycles  = 0;         // Skipped while halted in WAI
+        uint32_t skips        = 0;         // Number of fast-forwards
+        uint64_t apu_cycles   = 0;         // SPC700 cycles emulated
+        uint64_t apu_skipped  = 0;         // Of those, skipped in its polling loops
+    };
+    IdleLoopStats GetIdleLoopStats();
 
     // Input (frontend calls these)
     void SetButtonState(int pad, uint16_t buttons);  // Set joypad bitmask directly
 
+    // Called from inside RunFrame() right when the game samples the joypads
+    // (auto-joypad read, or a $4016/$4017 serial read), so input that arrived
+    // during the frame still counts. Only SetButtonState() may be called from
+    // it. Pass nullptr to unregister.
+    typedef void (*InputPollCallback)(void *userdata);
+    void SetInputPollCallback(InputPollCallback callback, void *userdata);
+
+    // Input recording and replay, for reproducible profiling runs. A log
+    // starts with a snapshot of the moment recording began (packed like a
+    // .suspend file) and holds every change of the joypads, stamped with the
+    // frame and the joypad sample in it where the game read it. With
+    // frame_hashes it also stores a hash of the machine state and of the
+    // picture after every frame, which the replay checks its own against.
+    // While a log is active, rewind is unavailable; during a replay, input
+    // from SetButtonState() and the poll callback is ignored until the log
+    // ends. Suspend() may be used; Resume() and LoadROM() end the log.
+    struct InputLogStatus {
+        bool     recording       = false;
+        bool     replaying       = false;  // Stays set after the last frame; see finished
+        bool     finished        = false;  // Replay reached the end of the log
+        uint64_t frame           = 0;      // Frames run since the log's snapshot
+        uint64_t frames          = 0;      // Replay: frames in the log
+        uint64_t hashes_checked  = 0;      // Replay: frames whose hashes were compared
+        uint64_t state_mismatches   = 0;   // RAM, VRAM, registers, sound RAM... differed
+        uint64_t picture_mismatches = 0;   // The frame as displayed differed
+        int64_t  first_mismatch  = -1;     // Frame of the first mismatch, or -1
+        uint64_t state_hash      = 0;      // Hashes of the last frame, with frame_hashes
+        uint64_t picture_hash    = 0;
+    };
+    bool InputRecordStart(const char *path, bool frame_hashes = false);
+    bool InputReplayStart(const char *path);   // Loads the log's snapshot
+    void InputLogStop();                   // Write out the recording, or end the replay
+    InputLogStatus GetInputLogStatus();
+
     // Accessors
     const uint16_t *GetFrameBuffer();      // -> GFX.Screen
     int GetFrameWidth();
     int GetFrameHeight();
+
+    // Rows of the frame buffer that changed since the previous call, one bit
+    // per row: row y is bit (y & 31) of rows[y >> 5]. Returns false when no
+    // row changed, so the upload can be skipped. A change of resolution marks
+    // every row. Detection compares a hash of each row as it was handed over.
+    const int DirtyRowWords = 16;          // 512 rows >= MAX_SNES_HEIGHT
+    bool GetDirtyRows(uint32_t rows[DirtyRowWords]);
+
+    // With native_line_width, a frame that mixes 256- and 512-pixel lines
+    // (a hires text box over a normal playfield) keeps each line at its own
+    // width, left-aligned in the frame buffer, for the GPU to scale. Returns
+    // the width of each of the GetFrameHeight() rows for such a frame, or
+    // nullptr when every row is GetFrameWidth() wide.
+    const uint16_t *GetLineWidths();
     bool IsPAL();
     const char *GetROMName();
 }
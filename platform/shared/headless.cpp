@@ -5,6 +5,13 @@
 \*****************************************************************************/
 
 #include "emulator.h"
+#include "snes9x.h"
+#include "memmap.h"
+#include "romprobe.h"
+
+// Results of the last emu_probe_dir(), valid until the next call
+static std::vector<std::string> probe_paths;
+static std::vector<SROMProbe>   probe_results;
 
 extern "C" {
 
@@ -19,5 +26,16 @@ int      emu_frame_height()                 { return Emulator::GetFrameHeight();
 const char *emu_rom_name()                  { return Emulator::GetROMName(); }
 bool     emu_is_pal()                       { return Emulator::IsPAL(); }
 void     emu_set_buttons(int pad, uint16_t mask) { Emulator::SetButtonState(pad, mask); }
+void     emu_set_input_poll(void (*callback)(void *), void *userdata) { Emulator::SetInputPollCallback(callback, userdata); }
+
+bool     emu_record_start(const char *path, bool frame_hashes) { return Emulator::InputRecordStart(path, frame_hashes); }
+bool     emu_replay_start(const char *path) { return Emulator::InputReplayStart(path); }
+void     emu_input_log_stop()               { Emulator::InputLogStop(); }
+void     emu_input_log_status(Emulator::InputLogStatus *out) { *out = Emulator::GetInputLogStatus(); }
+
+bool     emu_probe_rom(const char *path, SROMProbe *out) { return S9xProbeROM(path, out); }
+int      emu_probe_dir(const char *dir, bool recursive, int threads) { S9xProbeROMDirectory(dir, recursive, threads, probe_paths, probe_results); return (int) probe_results.size(); }
+const SROMProbe *emu_probe_results()        { return probe_results.data(); }
+const char *emu_probe_path(int i)           { return (i >= 0 && i < (int) probe_paths.size()) ? probe_paths[i].c_str() : nullptr; }
 
 }
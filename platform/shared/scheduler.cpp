@@ -0,0 +1,335 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+               This file is licensed under the Snes9x License.
+  For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#include "scheduler.h"
+
+#include "snes9x.h"
+#include "apu/apu.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t micros(Clock::duration d)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+// ---------------------------------------------------------------------------
+// Audio queue
+// ---------------------------------------------------------------------------
+
+// One stereo sample pair per entry. The emulation thread is the only writer
+// of s_queue_tail and the audio callback the only writer of s_queue_head, so
+// neither side ever takes a lock.
+static const uint32_t kQueueSize = 8192;   // Pairs; a power of two, ~250 ms
+static uint32_t s_queue[kQueueSize];
+static std::atomic<uint32_t> s_queue_head{0};
+static std::atomic<uint32_t> s_queue_tail{0};
+static uint32_t s_queue_target = 0;        // Emulate another frame below this fill
+static std::atomic<bool> s_primed{false};  // The queue reached its target once
+
+static uint32_t QueuedPairs()
+{
+    return s_queue_tail.load(std::memory_order_acquire) - s_queue_head.load(std::memory_order_acquire);
+}
+
+// Move the samples of the frame just emulated from the core's resampler
+static void QueueFrameAudio()
+{
+    static std::vector<int16_t> samples;
+
+    int count = S9xGetSampleCount() & ~1;
+    if (count <= 0)
+        return;
+    samples.resize(count);
+    S9xMixSamples((uint8 *)samples.data(), count);
+
+    uint32_t tail  = s_queue_tail.load(std::memory_order_relaxed);
+    uint32_t space = kQueueSize - QueuedPairs();
+    uint32_t pairs = std::min((uint32_t)count / 2, space);
+    for (uint32_t i = 0; i < pairs; i++)
+        memcpy(&s_queue[(tail + i) & (kQueueSize - 1)], &samples[i * 2], sizeof(uint32_t));
+    s_queue_tail.store(tail + pairs, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// Latest-frame mailbox
+// ---------------------------------------------------------------------------
+
+// Triple buffer: the emulation thread fills s_back, the display thread reads
+// s_front, and s_ready holds the third slot, with kFresh set while it holds a
+// frame the display hasn't taken. Both sides swap their slot with s_ready.
+struct Slot
+{
+    std::vector<uint16_t>    pixels;
+    uint16_t                 widths[MAX_SNES_HEIGHT];
+    AudioScheduler::Frame    frame;
+    Clock::time_point        started;
+};
+
+static const uint32_t kFresh = 4;
+static Slot s_slots[3];
+static std::atomic<uint32_t> s_ready{0};
+static uint32_t s_back  = 1;               // Emulation thread only
+static uint32_t s_front = 2;               // Display thread only
+static uint64_t s_last_shown = ~0ull;      // Display thread only
+
+// ---------------------------------------------------------------------------
+// Thread state and statistics
+// ---------------------------------------------------------------------------
+
+static std::thread s_thread;
+static std::atomic<bool> s_running{false};
+static std::atomic<bool> s_stop{false};
+static std::atomic<bool> s_paused{false};
+static std::atomic<bool> s_rewinding{false};
+static std::atomic<uint16_t> s_buttons[8];
+static std::atomic<uint32_t> s_pads{0};    // Pads set through SetButtonState()
+static uint64_t s_frame_number = 0;
+
+static std::atomic<uint64_t> s_frames_emulated{0};
+static std::atomic<uint64_t> s_frames_shown{0};
+static std::atomic<uint64_t> s_frames_dropped{0};
+static std::atomic<uint64_t> s_frames_repeated{0};
+static std::atomic<uint64_t> s_audio_callbacks{0};
+static std::atomic<uint64_t> s_audio_underruns{0};
+static std::atomic<uint64_t> s_underrun_frames{0};
+static std::atomic<uint64_t> s_queue_sum{0};        // Pairs queued, summed per frame
+static std::atomic<uint64_t> s_latency_sum_us{0};
+static std::atomic<uint64_t> s_latency_max_us{0};
+static std::atomic<uint64_t> s_emulate_sum_us{0};
+
+static void ApplyButtons(void *)
+{
+    uint32_t pads = s_pads.load(std::memory_order_relaxed);
+    for (int pad = 0; pad < 8; pad++)
+        if (pads & (1u << pad))
+            Emulator::SetButtonState(pad, s_buttons[pad].load(std::memory_order_relaxed));
+}
+
+static void PublishFrame(Clock::time_point started)
+{
+    Slot &slot = s_slots[s_back];
+    AudioScheduler::Frame &f = slot.frame;
+
+    f.width  = Emulator::GetFrameWidth();
+    f.height = Emulator::GetFrameHeight();
+    f.number = s_frame_number++;
+    slot.started = started;
+
+    const uint16_t *fb = Emulator::GetFrameBuffer();
+    for (int y = 0; y < f.height; y++)
+        memcpy(&slot.pixels[y * MAX_SNES_WIDTH], fb + y * MAX_SNES_WIDTH, f.width * sizeof(uint16_t));
+
+    const uint16_t *widths = Emulator::GetLineWidths();
+    if (widths)
+        memcpy(slot.widths, widths, f.height * sizeof(uint16_t));
+    f.line_widths = widths ? slot.widths : nullptr;
+
+    Emulator::GetDirtyRows(f.dirty);
+
+    uint32_t prev = s_ready.exchange(s_back | kFresh, std::memory_order_acq_rel);
+    if (prev & kFresh)
+        s_frames_dropped++;
+    s_back = prev & ~kFresh;
+}
+
+static void EmulationThread()
+{
+    const double rate = Settings.SoundPlaybackRate;
+
+    Emulator::SetInputPollCallback(ApplyButtons, nullptr);
+
+    while (!s_stop.load(std::memory_order_acquire)) {
+        if (s_paused.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+
+        // The queue drains at the playback rate; sleep until it is below target
+        uint32_t queued = QueuedPairs();
+        if (queued >= s_queue_target) {
+            s_primed.store(true, std::memory_order_relaxed);
+            double us = (queued - s_queue_target + 1) * 1e6 / rate;
+            std::this_thread::sleep_for(std::chrono::microseconds((int64_t)std::clamp(us, 500.0, 20000.0)));
+            continue;
+        }
+
+        Clock::time_point started = Clock::now();
+
+        bool rewind = s_rewinding.load(std::memory_order_relaxed);
+        if (rewind && !Emulator::IsRewinding())
+            Emulator::RewindStartContinuous();
+        else if (!rewind && Emulator::IsRewinding())
+            Emulator::RewindStop();
+
+        ApplyButtons(nullptr);
+        if (Emulator::IsRewinding())
+            Emulator::RewindTick();
+        else
+            Emulator::RunFrame();
+
+        QueueFrameAudio();
+        PublishFrame(started);
+
+        s_frames_emulated++;
+        s_queue_sum += QueuedPairs();
+        s_emulate_sum_us += micros(Clock::now() - started);
+    }
+
+    Emulator::SetInputPollCallback(nullptr, nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// AudioScheduler namespace implementation
+// ---------------------------------------------------------------------------
+
+namespace AudioScheduler {
+
+bool Start(int buffer_ms)
+{
+    if (s_running)
+        return true;
+
+    for (Slot &slot : s_slots)
+        slot.pixels.resize(MAX_SNES_WIDTH * MAX_SNES_HEIGHT);
+    s_ready = 0;
+    s_back  = 1;
+    s_front = 2;
+    s_last_shown = ~0ull;
+
+    s_queue_head = 0;
+    s_queue_tail = 0;
+    s_queue_target = std::min<uint32_t>(Settings.SoundPlaybackRate * buffer_ms / 1000, kQueueSize / 2);
+    s_primed = false;
+
+    s_frames_emulated = s_frames_shown = s_frames_dropped = s_frames_repeated = 0;
+    s_audio_callbacks = s_audio_underruns = s_underrun_frames = 0;
+    s_queue_sum = s_latency_sum_us = s_latency_max_us = s_emulate_sum_us = 0;
+
+    s_stop = false;
+    s_running = true;
+    s_thread = std::thread(EmulationThread);
+    return true;
+}
+
+void Stop()
+{
+    if (!s_running)
+        return;
+
+    s_stop = true;
+    s_thread.join();
+    s_running = false;
+}
+
+bool IsRunning()
+{
+    return s_running;
+}
+
+void SetPaused(bool paused)
+{
+    s_paused = paused;
+}
+
+void SetRewinding(bool rewinding)
+{
+    s_rewinding = rewinding;
+}
+
+void SetButtonState(int pad, uint16_t buttons)
+{
+    if (pad < 0 || pad >= 8)
+        return;
+    s_buttons[pad].store(buttons, std::memory_order_relaxed);
+    s_pads.fetch_or(1u << pad, std::memory_order_relaxed);
+}
+
+void MixSamples(int16_t *out, int frames)
+{
+    if (!s_running.load(std::memory_order_relaxed) || s_paused.load(std::memory_order_relaxed)) {
+        memset(out, 0, frames * 2 * sizeof(int16_t));
+        return;
+    }
+
+    uint32_t head = s_queue_head.load(std::memory_order_relaxed);
+    uint32_t have = s_queue_tail.load(std::memory_order_acquire) - head;
+    uint32_t n    = std::min((uint32_t)frames, have);
+
+    for (uint32_t i = 0; i < n; i++)
+        memcpy(out + i * 2, &s_queue[(head + i) & (kQueueSize - 1)], sizeof(uint32_t));
+    s_queue_head.store(head + n, std::memory_order_release);
+
+    if (n < (uint32_t)frames)
+        memset(out + n * 2, 0, (frames - n) * 2 * sizeof(int16_t));
+
+    // Before the queue first fills up, running dry is just the start-up
+    if (s_primed.load(std::memory_order_relaxed)) {
+        s_audio_callbacks++;
+        if (n < (uint32_t)frames) {
+            s_audio_underruns++;
+            s_underrun_frames += frames - n;
+        }
+    }
+}
+
+const Frame *AcquireFrame()
+{
+    if (!(s_ready.load(std::memory_order_acquire) & kFresh)) {
+        s_frames_repeated++;
+        return nullptr;
+    }
+
+    uint32_t prev = s_ready.exchange(s_front, std::memory_order_acq_rel);
+    s_front = prev & ~kFresh;
+
+    Slot &slot = s_slots[s_front];
+    slot.frame.pixels = slot.pixels.data();
+    slot.frame.full_upload = slot.frame.number != s_last_shown + 1;
+    s_last_shown = slot.frame.number;
+
+    uint64_t latency = micros(Clock::now() - slot.started);
+    s_frames_shown++;
+    s_latency_sum_us += latency;
+    uint64_t max = s_latency_max_us.load(std::memory_order_relaxed);
+    while (latency > max && !s_latency_max_us.compare_exchange_weak(max, latency))
+        ;
+
+    return &slot.frame;
+}
+
+Stats GetStats()
+{
+    Stats stats;
+    const double rate = Settings.SoundPlaybackRate ? Settings.SoundPlaybackRate : 32040;
+
+    stats.frames_emulated = s_frames_emulated;
+    stats.frames_shown    = s_frames_shown;
+    stats.frames_dropped  = s_frames_dropped;
+    stats.frames_repeated = s_frames_repeated;
+    stats.audio_callbacks = s_audio_callbacks;
+    stats.audio_underruns = s_audio_underruns;
+    stats.underrun_frames = s_underrun_frames;
+
+    if (stats.frames_emulated) {
+        stats.audio_queue_ms = s_queue_sum * 1000.0 / rate / stats.frames_emulated;
+        stats.emulate_ms     = s_emulate_sum_us / 1000.0 / stats.frames_emulated;
+    }
+    if (stats.frames_shown)
+        stats.latency_ms = s_latency_sum_us / 1000.0 / stats.frames_shown;
+    stats.latency_max_ms = s_latency_max_us / 1000.0;
+
+    return stats;
+}
+
+} // namespace AudioScheduler
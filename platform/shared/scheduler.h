@@ -0,0 +1,69 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+               This file is licensed under the Snes9x License.
+  For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <cstdint>
+
+#include "emulator.h"
+
+// Audio-clocked scheduler: the alternative to the vsync throttle described in
+// docs/TIMING_STRATEGIES.md (config: audio_clock). A dedicated thread runs
+// the emulation one frame at a time whenever the audio queue drops below its
+// target fill, so the sound device's clock sets the speed and nothing is
+// resampled. Finished frames go to a latest-frame mailbox that the display
+// thread reads at its own refresh rate; a display slower than the game drops
+// frames, a faster one shows some twice.
+//
+// While the scheduler runs, it owns the core: the frontend must not call
+// Emulator:: functions other than the read-only rewind accessors. Stop() it
+// before Suspend(), Resume(), LoadROM() or Shutdown().
+
+namespace AudioScheduler {
+    bool Start(int buffer_ms = 40);        // After LoadROM(): start the emulation thread
+    void Stop();                           // Stop and join it
+    bool IsRunning();
+
+    // Control (any thread)
+    void SetPaused(bool paused);           // Stop emulating; audio plays silence
+    void SetRewinding(bool rewinding);     // Rewind instead of running (RewindTick per frame)
+    void SetButtonState(int pad, uint16_t buttons);  // Applied when the game reads the joypads
+
+    // Audio thread: fill out with frames stereo sample pairs. Never blocks.
+    void MixSamples(int16_t *out, int frames);
+
+    // Display thread: the newest finished frame, or nullptr if there is none
+    // since the last call (show the previous one again). The frame stays valid
+    // until the next call.
+    struct Frame {
+        const uint16_t *pixels;            // Pitch is MAX_SNES_WIDTH
+        int width;
+        int height;
+        const uint16_t *line_widths;       // As Emulator::GetLineWidths()
+        uint32_t dirty[Emulator::DirtyRowWords];  // Rows changed since the frame before it
+        bool full_upload;                  // Frames were dropped in between: dirty doesn't apply
+        uint64_t number;                   // Frames emulated before this one
+    };
+    const Frame *AcquireFrame();
+
+    struct Stats {
+        uint64_t frames_emulated  = 0;
+        uint64_t frames_shown     = 0;     // Distinct frames taken by AcquireFrame()
+        uint64_t frames_dropped   = 0;     // Replaced in the mailbox before the display took them
+        uint64_t frames_repeated  = 0;     // AcquireFrame() calls with no new frame
+        uint64_t audio_callbacks  = 0;
+        uint64_t audio_underruns  = 0;     // Callbacks that ran out of samples
+        uint64_t underrun_frames  = 0;     // Sample pairs of silence inserted by those
+        double   audio_queue_ms   = 0;     // Average audio queued when a frame finishes
+        double   latency_ms       = 0;     // Average from the start of a frame to AcquireFrame()
+        double   latency_max_ms   = 0;
+        double   emulate_ms       = 0;     // Average time to emulate one frame
+    };
+    Stats GetStats();                      // Since Start()
+}
+
+#endif
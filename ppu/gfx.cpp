@@ -29,6 +29,114 @@ static inline void RenderScreen (bool8);
 
 #define TILE_PLUS(t, x)	(((t) & 0xfc00) | (((t) + (x)) & 0x3ff))
 
+// Sprite-to-line membership for the normal (non-rotating) priority case,
+// kept between SetupOBJ calls so single OAM writes don't rebuild every line.
+static struct
+{
+	bool8	Valid;
+	uint8	SizeSelect;
+	uint8	StartLine;
+	uint8	Inc;
+	uint8	FirstSprite;
+	int		MaxTiles;
+	uint8	Start[128];								// first line covered by each sprite
+	uint8	Count[128];								// lines covered, 0 if off screen
+	uint32	Members[SNES_HEIGHT_EXTENDED][4];		// sprites present on each line
+	uint8	RTOFlags[SNES_HEIGHT_EXTENDED];			// per-line flags before they are carried down
+}	OBJList;
+
+// Hash of each row of the last frame handed to the frontend. A row whose
+// hash changes is marked in GFX.DirtyRows, so that the frontend can upload
+// only those rows, or nothing at all for an identical frame.
+static struct
+{
+	uint32	Width;
+	uint32	Height;
+	uint64	Hash[MAX_SNES_HEIGHT];
+}	RowHashes;
+
+static void UpdateDirtyRows (void)
+{
+	uint32	width  = IPPU.RenderedScreenWidth;
+	uint32	height = IPPU.RenderedScreenHeight;
+	bool8	all    = (width != RowHashes.Width || height != RowHashes.Height);
+
+	RowHashes.Width  = width;
+	RowHashes.Height = height;
+
+	for (uint32 y = 0; y < height; y++)
+	{
+		const uint16	*p = GFX.Screen + y * GFX.RealPPL;
+		uint64			h = GFX.MixedWidths ? GFX.LineWidth[y] : width;
+
+		for (uint32 x = 0; x < width; x += 4)
+		{
+			uint64	w;
+			memcpy(&w, p + x, sizeof(w));
+			h = ((h << 23) | (h >> 41)) ^ w;
+			h *= 0x9e3779b97f4a7c15ull;
+		}
+
+		if (all || h != RowHashes.Hash[y])
+		{
+			RowHashes.Hash[y] = h;
+			GFX.DirtyRows[y >> 5] |= 1u << (y & 31);
+		}
+	}
+}
+
+// With Settings.NativeLineWidth, find out whether the frame mixes 256- and
+// 512-pixel rows. If on-screen text is about to be drawn across them, widen
+// the narrow rows after all, so that the text comes out right.
+static void CheckLineWidths (void)
+{
+	GFX.MixedWidths = false;
+
+	if (!Settings.NativeLineWidth)
+		return;
+
+	const uint16	black = BUILD_PIXEL(0, 0, 0);
+
+	for (int y = 0; y < IPPU.RenderedScreenHeight; y++)
+	{
+		if (GFX.LineWidth[y] == 0)
+		{
+			// Force-blanked: black across the frame's final width
+			uint16	*p = GFX.Screen + y * GFX.RealPPL;
+			for (int x = 0; x < IPPU.RenderedScreenWidth; x++)
+				p[x] = black;
+			GFX.LineWidth[y] = IPPU.RenderedScreenWidth;
+		}
+		else if (GFX.LineWidth[y] != IPPU.RenderedScreenWidth)
+			GFX.MixedWidths = true;
+	}
+
+	if (GFX.MixedWidths && Settings.AutoDisplayMessages && !GFX.InfoString.empty())
+	{
+		for (int y = 0; y < IPPU.RenderedScreenHeight; y++)
+		{
+			if (GFX.LineWidth[y] == IPPU.RenderedScreenWidth)
+				continue;
+
+			uint16	*p = GFX.Screen + y * GFX.RealPPL + 255;
+			uint16	*q = GFX.Screen + y * GFX.RealPPL + 510;
+
+			for (int x = 255; x >= 0; x--, p--, q -= 2)
+				*q = *(q + 1) = *p;
+
+			GFX.LineWidth[y] = IPPU.RenderedScreenWidth;
+		}
+
+		GFX.MixedWidths = false;
+	}
+}
+
+static inline bool8 OBJNeedsSetup (void)
+{
+	return (IPPU.OBJChanged ||
+		(IPPU.OBJSpriteChanged[0] | IPPU.OBJSpriteChanged[1] | IPPU.OBJSpriteChanged[2] | IPPU.OBJSpriteChanged[3]) != 0);
+}
+
 
 bool8 S9xGraphicsInit (void)
 {
@@ -47,8 +155,13 @@ bool8 S9xGraphicsInit (void)
 	GFX.SubScreen  = (uint16 *) malloc(GFX.ScreenSize * sizeof(uint16));
 	GFX.ZBuffer    = (uint8 *)  malloc(GFX.ScreenSize);
 	GFX.SubZBuffer = (uint8 *)  malloc(GFX.ScreenSize);
+	GFX.MathBuffer = (uint8 *)  malloc(GFX.ScreenSize);
+	RowHashes.Width = RowHashes.Height = 0;
+	for (uint32 y = 0; y < MAX_SNES_HEIGHT; y++)
+		GFX.LineWidth[y] = SNES_WIDTH;
+	GFX.MixedWidths = false;
 
-	if (!GFX.ZERO || !GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer)
+	if (!GFX.ZERO || !GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer || !GFX.MathBuffer)
 	{
 		S9xGraphicsDeinit();
 		return false;
@@ -95,6 +208,7 @@ void S9xGraphicsDeinit (void)
 	if (GFX.SubScreen)  { free(GFX.SubScreen);  GFX.SubScreen  = nullptr; }
 	if (GFX.ZBuffer)    { free(GFX.ZBuffer);    GFX.ZBuffer    = nullptr; }
 	if (GFX.SubZBuffer) { free(GFX.SubZBuffer); GFX.SubZBuffer = nullptr; }
+	if (GFX.MathBuffer) { free(GFX.MathBuffer); GFX.MathBuffer = nullptr; }
 }
 
 void S9xGraphicsScreenResize (void)
@@ -186,10 +300,13 @@ void S9xEndScreenRefresh (void)
 	if (IPPU.RenderThisFrame)
 	{
 		FLUSH_REDRAW();
+		FLUSH_DEFERRED();
 
 		if (GFX.DoInterlace && S9xInterlaceField() == 0)
 		{
 			S9xControlEOF();
+			CheckLineWidths();
+			UpdateDirtyRows();
 			S9xContinueUpdate(IPPU.RenderedScreenWidth, IPPU.RenderedScreenHeight);
 		}
 		else
@@ -202,10 +319,12 @@ void S9xEndScreenRefresh (void)
 			}
 
 			S9xControlEOF();
+			CheckLineWidths();
 
 			if (Settings.AutoDisplayMessages)
 				S9xDisplayMessages(GFX.Screen, GFX.RealPPL, IPPU.RenderedScreenWidth, IPPU.RenderedScreenHeight, 1);
 
+			UpdateDirtyRows();
 			S9xDeinitUpdate(IPPU.RenderedScreenWidth, IPPU.RenderedScreenHeight);
 		}
 	}
@@ -283,7 +402,7 @@ void RenderLine (uint8 C)
 	{
 		// if we're not rendering this frame, we still need to update this
 		// XXX: Check ForceBlank? Or anything else?
-		if (IPPU.OBJChanged)
+		if (OBJNeedsSetup())
 			SetupOBJ();
 		PPU.RangeTimeOver |= GFX.OBJLines[C].RTOFlags;
 	}
@@ -415,11 +534,15 @@ static inline void RenderScreen (bool8 sub)
 	BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & 0x20);
 
 	DrawBackdrop();
+
+	// The backdrop has touched every pixel, so every math flag is current.
+	if (GFX.DeferredMath)
+		GFX.ComposeMath(GFX.StartY * GFX.PPL, SNES_WIDTH);
 }
 
 void S9xUpdateScreen (void)
 {
-	if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
+	if (OBJNeedsSetup() || IPPU.InterlaceOBJ)
 		SetupOBJ();
 
 	// XXX: Check ForceBlank? Or anything else?
@@ -440,7 +563,15 @@ void S9xUpdateScreen (void)
 			PPU.RecomputeClipWindows = false;
 		}
 
-		if (!IPPU.DoubleWidthPixels && (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires))
+		if (Settings.NativeLineWidth)
+		{
+			// Draw each band at its own width and leave the lines above as
+			// they are. GFX.LineWidth tells the frontend which is which.
+			IPPU.DoubleWidthPixels = (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires);
+			if (IPPU.DoubleWidthPixels)
+				IPPU.RenderedScreenWidth = 512;
+		}
+		else if (!IPPU.DoubleWidthPixels && (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires))
 		{
 			// Have to back out of the regular speed hack
 			for (uint32 y = 0; y < GFX.StartY; y++)
@@ -464,7 +595,10 @@ void S9xUpdateScreen (void)
 			GFX.DoInterlace = 2;
 
 			for (int32 y = (int32) GFX.StartY - 2; y >= 0; y--)
+			{
 				memmove(GFX.Screen + (y + 1) * GFX.PPL, GFX.Screen + y * GFX.RealPPL, GFX.PPL * sizeof(uint16));
+				memmove(GFX.LineWidth + (y + 1) * 2, GFX.LineWidth + y, 2 * sizeof(uint16));
+			}
 		}
 
 		if ((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2131] & 0x3f))
@@ -491,9 +625,138 @@ void S9xUpdateScreen (void)
 				GFX.S[x] = black;
 	}
 
+	if (Settings.NativeLineWidth)
+	{
+		// A black line looks the same at either width: 0 leaves it to
+		// CheckLineWidths() to give it the width the frame ends up with
+		uint32	step  = GFX.PPL / GFX.RealPPL;
+		uint32	row   = GFX.StartY * step + (GFX.DoInterlace && S9xInterlaceField() ? 1 : 0);
+		uint16	width = PPU.ForcedBlanking ? 0 : IPPU.DoubleWidthPixels ? SNES_WIDTH << 1 : SNES_WIDTH;
+
+		for (uint32 l = GFX.StartY; l <= GFX.EndY; l++, row += step)
+			GFX.LineWidth[row] = width;
+	}
+
+	IPPU.PreviousLine = IPPU.CurrentLine;
+}
+
+// With Settings.DeferredRendering, FLUSH_REDRAW snapshots everything
+// S9xUpdateScreen reads for the finished lines instead of drawing them, and
+// the frame is drawn band by band at the end. Per-line scroll and Mode 7
+// values are already in LineData/LineMatrixData. VRAM isn't copied, so VRAM
+// writes draw the queued bands first.
+static struct
+{
+	int		StartLine;
+	int		EndLine;
+	struct SPPU	PPU;
+	uint8	Registers[0x40];		// $2100-$213f
+	uint16	ScreenColors[256];
+	uint8	MaxBrightness;
+	bool8	Interlace;
+	bool8	InterlaceOBJ;
+	bool8	PseudoHires;
+	bool8	OBJChanged;
+	uint32	OBJSpriteChanged[4];
+}	DeferredBand[SNES_HEIGHT_EXTENDED + 1];
+
+void S9xDeferScreen (void)
+{
+	if (GFX.DeferredBands == SNES_HEIGHT_EXTENDED + 1)
+		S9xRenderDeferred();
+
+	auto &b = DeferredBand[GFX.DeferredBands++];
+
+	b.StartLine = IPPU.PreviousLine;
+	b.EndLine = IPPU.CurrentLine;
+	b.PPU = PPU;
+	memcpy(b.Registers, &Memory.FillRAM[0x2100], sizeof(b.Registers));
+	memcpy(b.ScreenColors, IPPU.ScreenColors, sizeof(b.ScreenColors));
+	b.MaxBrightness = IPPU.MaxBrightness;
+	b.Interlace = IPPU.Interlace;
+	b.InterlaceOBJ = IPPU.InterlaceOBJ;
+	b.PseudoHires = IPPU.PseudoHires;
+	b.OBJChanged = IPPU.OBJChanged;
+	memcpy(b.OBJSpriteChanged, IPPU.OBJSpriteChanged, sizeof(b.OBJSpriteChanged));
+
+	// The band now owns these, as if S9xUpdateScreen had consumed them.
+	PPU.RecomputeClipWindows = false;
+	IPPU.OBJChanged = false;
+	memset(IPPU.OBJSpriteChanged, 0, sizeof(IPPU.OBJSpriteChanged));
+
 	IPPU.PreviousLine = IPPU.CurrentLine;
 }
 
+void S9xRenderDeferred (void)
+{
+	struct SPPU	LivePPU;
+	uint8	LiveRegisters[0x40];
+	uint16	LiveScreenColors[256];
+	uint32	LiveOBJSpriteChanged[4];
+
+	LivePPU = PPU;
+	memcpy(LiveRegisters, &Memory.FillRAM[0x2100], sizeof(LiveRegisters));
+	memcpy(LiveScreenColors, IPPU.ScreenColors, sizeof(LiveScreenColors));
+	memcpy(LiveOBJSpriteChanged, IPPU.OBJSpriteChanged, sizeof(LiveOBJSpriteChanged));
+	uint8	LiveMaxBrightness = IPPU.MaxBrightness;
+	bool8	LiveInterlace = IPPU.Interlace;
+	bool8	LiveInterlaceOBJ = IPPU.InterlaceOBJ;
+	bool8	LivePseudoHires = IPPU.PseudoHires;
+	bool8	LiveOBJChanged = IPPU.OBJChanged;
+	int		LivePreviousLine = IPPU.PreviousLine;
+	int		LiveCurrentLine = IPPU.CurrentLine;
+
+	uint8	Brightness = PPU.Brightness;
+	uint8	RTO = 0;
+
+	for (uint32 i = 0; i < GFX.DeferredBands; i++)
+	{
+		auto &b = DeferredBand[i];
+
+		PPU = b.PPU;
+		memcpy(&Memory.FillRAM[0x2100], b.Registers, sizeof(b.Registers));
+		if (PPU.Brightness != Brightness)
+		{
+			S9xFixColourBrightness();
+			S9xBuildDirectColourMaps();
+			Brightness = PPU.Brightness;
+		}
+		memcpy(IPPU.ScreenColors, b.ScreenColors, sizeof(b.ScreenColors));
+		IPPU.MaxBrightness = b.MaxBrightness;
+		IPPU.Interlace = b.Interlace;
+		IPPU.InterlaceOBJ = b.InterlaceOBJ;
+		IPPU.PseudoHires = b.PseudoHires;
+		IPPU.OBJChanged = b.OBJChanged;
+		memcpy(IPPU.OBJSpriteChanged, b.OBJSpriteChanged, sizeof(b.OBJSpriteChanged));
+		IPPU.PreviousLine = b.StartLine;
+		IPPU.CurrentLine = b.EndLine;
+
+		PPU.RangeTimeOver = 0;
+		S9xUpdateScreen();
+		RTO |= PPU.RangeTimeOver;
+	}
+
+	GFX.DeferredBands = 0;
+
+	PPU = LivePPU;
+	PPU.RangeTimeOver |= RTO;
+	memcpy(&Memory.FillRAM[0x2100], LiveRegisters, sizeof(LiveRegisters));
+	if (PPU.Brightness != Brightness)
+	{
+		S9xFixColourBrightness();
+		S9xBuildDirectColourMaps();
+	}
+	memcpy(IPPU.ScreenColors, LiveScreenColors, sizeof(LiveScreenColors));
+	memcpy(IPPU.OBJSpriteChanged, LiveOBJSpriteChanged, sizeof(LiveOBJSpriteChanged));
+	IPPU.MaxBrightness = LiveMaxBrightness;
+	IPPU.Interlace = LiveInterlace;
+	IPPU.InterlaceOBJ = LiveInterlaceOBJ;
+	IPPU.PseudoHires = LivePseudoHires;
+	IPPU.OBJChanged = LiveOBJChanged;
+	IPPU.PreviousLine = LivePreviousLine;
+	IPPU.CurrentLine = LiveCurrentLine;
+}
+
 static void SetupOBJ (void)
 {
 	int	SmallWidth, SmallHeight, LargeWidth, LargeHeight;
@@ -556,22 +819,52 @@ static void SetupOBJ (void)
 
 	if (!PPU.OAMPriorityRotation || !(PPU.OAMFlip & PPU.OAMAddr & 1)) // normal case
 	{
-		uint8	LineOBJ[SNES_HEIGHT_EXTENDED];
-		memset(LineOBJ, 0, sizeof(LineOBJ));
-
-		for (int i = 0; i < SNES_HEIGHT_EXTENDED; i++)
+		// Which sprites sit on which lines is kept between calls, so only
+		// the sprites REGISTER_2104 flagged and the lines they left or
+		// entered need to be revisited. Anything else invalidates it all.
+		bool8	LineChanged[SNES_HEIGHT_EXTENDED];
+		uint32	Changed[4];
+
+		if (IPPU.OBJChanged || !OBJList.Valid ||
+			OBJList.SizeSelect != PPU.OBJSizeSelect || OBJList.StartLine != startline || OBJList.Inc != inc ||
+			OBJList.MaxTiles != Settings.MaxSpriteTilesPerLine)
+		{
+			memset(OBJList.Members, 0, sizeof(OBJList.Members));
+			memset(OBJList.Count, 0, sizeof(OBJList.Count));
+			memset(Changed, 0xff, sizeof(Changed));
+			memset(LineChanged, true, sizeof(LineChanged));
+
+			OBJList.Valid = true;
+			OBJList.SizeSelect = PPU.OBJSizeSelect;
+			OBJList.StartLine = startline;
+			OBJList.Inc = inc;
+			OBJList.MaxTiles = Settings.MaxSpriteTilesPerLine;
+		}
+		else
 		{
-			GFX.OBJLines[i].RTOFlags = 0;
-			GFX.OBJLines[i].Tiles = Settings.MaxSpriteTilesPerLine;
-			for (int j = 0; j < sprite_limit; j++)
-				GFX.OBJLines[i].OBJ[j].Sprite = -1;
+			memcpy(Changed, IPPU.OBJSpriteChanged, sizeof(Changed));
+			memset(LineChanged, OBJList.FirstSprite != PPU.FirstSprite, sizeof(LineChanged));
 		}
 
-		uint8	FirstSprite = PPU.FirstSprite;
-		S = FirstSprite;
+		OBJList.FirstSprite = PPU.FirstSprite;
 
-		do
+		for (S = 0; S < 128; S++)
 		{
+			if (!(Changed[S >> 5] & (1u << (S & 31))))
+				continue;
+
+			// Take the sprite off the lines it used to cover.
+			for (uint8 k = 0, Y = OBJList.Start[S]; k < OBJList.Count[S]; k++, Y++)
+			{
+				if (Y >= SNES_HEIGHT_EXTENDED)
+					continue;
+
+				OBJList.Members[Y][S >> 5] &= ~(1u << (S & 31));
+				LineChanged[Y] = true;
+			}
+
+			OBJList.Count[S] = 0;
+
 			if (PPU.OBJ[S].Size)
 			{
 				GFX.OBJWidths[S] = LargeWidth;
@@ -596,38 +889,67 @@ static void SetupOBJ (void)
 				else
 					GFX.OBJVisibleTiles[S] = GFX.OBJWidths[S] >> 3;
 
-				for (uint8 line = startline, Y = (uint8) (PPU.OBJ[S].VPos & 0xff); line < Height; Y++, line += inc)
+				OBJList.Start[S] = (uint8) (PPU.OBJ[S].VPos & 0xff);
+				OBJList.Count[S] = (Height - startline + inc - 1) / inc;
+
+				for (uint8 k = 0, Y = OBJList.Start[S]; k < OBJList.Count[S]; k++, Y++)
 				{
 					if (Y >= SNES_HEIGHT_EXTENDED)
 						continue;
 
-					if (LineOBJ[Y] >= sprite_limit)
-					{
-						GFX.OBJLines[Y].RTOFlags |= 0x40;
-						continue;
-					}
+					OBJList.Members[Y][S >> 5] |= 1u << (S & 31);
+					LineChanged[Y] = true;
+				}
+			}
+		}
+
+		// Rebuild the touched lines in priority order, starting at FirstSprite.
+		for (int Y = 0; Y < SNES_HEIGHT_EXTENDED; Y++)
+		{
+			if (!LineChanged[Y])
+				continue;
 
-					GFX.OBJLines[Y].Tiles -= GFX.OBJVisibleTiles[S];
-					if (GFX.OBJLines[Y].Tiles < 0)
-						GFX.OBJLines[Y].RTOFlags |= 0x80;
+			uint8	RTOFlags = 0;
+			int		j = 0;
 
-					GFX.OBJLines[Y].OBJ[LineOBJ[Y]].Sprite = S;
-					if (PPU.OBJ[S].VFlip)
-						// Yes, Width not Height. It so happens that the
-						// sprites with H=2*W flip as two WxW sprites.
-						GFX.OBJLines[Y].OBJ[LineOBJ[Y]].Line = line ^ (GFX.OBJWidths[S] - 1);
-					else
-						GFX.OBJLines[Y].OBJ[LineOBJ[Y]].Line = line;
+			GFX.OBJLines[Y].Tiles = Settings.MaxSpriteTilesPerLine;
 
-					LineOBJ[Y]++;
+			for (int n = 0; n < 128; n++)
+			{
+				S = (PPU.FirstSprite + n) & 0x7f;
+				if (!(OBJList.Members[Y][S >> 5] & (1u << (S & 31))))
+					continue;
+
+				if (j >= sprite_limit)
+				{
+					RTOFlags |= 0x40;
+					break;
 				}
+
+				GFX.OBJLines[Y].Tiles -= GFX.OBJVisibleTiles[S];
+				if (GFX.OBJLines[Y].Tiles < 0)
+					RTOFlags |= 0x80;
+
+				uint8	line = startline + (uint8) (Y - PPU.OBJ[S].VPos) * inc;
+
+				GFX.OBJLines[Y].OBJ[j].Sprite = S;
+				if (PPU.OBJ[S].VFlip)
+					// Yes, Width not Height. It so happens that the
+					// sprites with H=2*W flip as two WxW sprites.
+					GFX.OBJLines[Y].OBJ[j++].Line = line ^ (GFX.OBJWidths[S] - 1);
+				else
+					GFX.OBJLines[Y].OBJ[j++].Line = line;
 			}
 
-			S = (S + 1) & 0x7f;
-		} while (S != FirstSprite);
+			for (; j < sprite_limit; j++)
+				GFX.OBJLines[Y].OBJ[j].Sprite = -1;
+
+			OBJList.RTOFlags[Y] = RTOFlags;
+		}
 
+		GFX.OBJLines[0].RTOFlags = OBJList.RTOFlags[0];
 		for (int Y = 1; Y < SNES_HEIGHT_EXTENDED; Y++)
-			GFX.OBJLines[Y].RTOFlags |= GFX.OBJLines[Y - 1].RTOFlags;
+			GFX.OBJLines[Y].RTOFlags = OBJList.RTOFlags[Y] | GFX.OBJLines[Y - 1].RTOFlags;
 	}
 	else // evil FirstSprite+Y case
 	{
@@ -724,9 +1046,12 @@ static void SetupOBJ (void)
 			if (j < sprite_limit)
 				GFX.OBJLines[Y].OBJ[j].Sprite = -1;
 		}
+
+		OBJList.Valid = false;
 	}
 
 	IPPU.OBJChanged = false;
+	memset(IPPU.OBJSpriteChanged, 0, sizeof(IPPU.OBJSpriteChanged));
 }
 
 #if defined(__GNUC__) && !defined(__clang__)
@@ -20,6 +20,7 @@ struct SGFX
 	uint16	*SubScreen;
 	uint8	*ZBuffer;
 	uint8	*SubZBuffer;
+	uint8	*MathBuffer;		// per-pixel deferred colour math flags for the main screen
 	uint16	*S;
 	uint8	*DB;
 	uint16	*ZERO;
@@ -34,6 +35,11 @@ struct SGFX
 	uint32	StartY;
 	uint32	EndY;
 	bool8	ClipColors;
+	bool8	DeferredMath;		// main screen colour math is applied by ComposeMath after all layers
+	uint32	DeferredBands;		// line bands captured by S9xDeferScreen, not yet drawn
+	uint32	DirtyRows[(MAX_SNES_HEIGHT + 31) / 32];	// rows of Screen changed since the frontend cleared them
+	uint16	LineWidth[MAX_SNES_HEIGHT];	// with Settings.NativeLineWidth, the width each row was drawn at (0: force-blanked, until the frame ends)
+	bool8	MixedWidths;		// the last frame has rows narrower than RenderedScreenWidth
 	uint8	OBJWidths[128];
 	uint8	OBJVisibleTiles[128];
 
@@ -63,6 +69,7 @@ struct SGFX
 	void	(*DrawMode7BG1Nomath) (uint32, uint32, int);
 	void	(*DrawMode7BG2Math) (uint32, uint32, int);
 	void	(*DrawMode7BG2Nomath) (uint32, uint32, int);
+	void	(*ComposeMath) (uint32, uint32);
 
 	std::string InfoString;
 	uint32	InfoStringTimeout;
@@ -93,6 +100,9 @@ struct SBG
 	uint8	*BufferFlip;
 	uint8	*Buffered;
 	uint8	*BufferedFlip;
+	uint32	*Stamp;
+	uint32	*StampFlip;
+	bool8	PairedTiles;		// hires converters also read the tile after
 	bool8	DirectColourMode;
 };
 
@@ -546,10 +546,12 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 				break;
 
 			case 0x2118: // VMDATAL
+				FLUSH_DEFERRED();
 				REGISTER_2118(Byte);
 				break;
 
 			case 0x2119: // VMDATAH
+				FLUSH_DEFERRED();
 				REGISTER_2119(Byte);
 				break;
 
@@ -847,6 +849,9 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 			case 0x2133: // SETINI
 				if (Byte != Memory.FillRAM[0x2133])
 				{
+					// RenderedScreenHeight below depends on what's been drawn so far
+					FLUSH_DEFERRED();
+
 					if ((Memory.FillRAM[0x2133] ^ Byte) & 8)
 					{
 						FLUSH_REDRAW();
@@ -1172,6 +1177,7 @@ uint8 S9xGetPPU (uint16 Address)
 
 			case 0x213e: // STAT77
 				FLUSH_REDRAW();
+				FLUSH_DEFERRED();
 				byte = (PPU.OpenBus1 & 0x10) | PPU.RangeTimeOver | Model->_5C77;
 				return (PPU.OpenBus1 = byte);
 
@@ -1543,6 +1549,7 @@ void S9xSetCPU (uint8 Byte, uint16 Address)
 					}
 					else
 						CPU.FastROMSpeed = SLOW_ONE_CYCLE;
+					Memory.map_FastROMSpeed();
 					// we might currently be in FastROMSpeed region, S9xSetPCBase will update CPU.MemSpeed
 					S9xSetPCBase(Registers.PBPC);
 				}
@@ -1735,13 +1742,20 @@ void S9xResetPPUFast (void)
 	PPU.RecomputeClipWindows = true;
 	IPPU.ColorsChanged = true;
 	IPPU.OBJChanged = true;
-	memset(IPPU.TileCached[TILE_2BIT], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_8BIT], 0, MAX_8BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_EVEN], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_ODD], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_EVEN], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_ODD], 0, MAX_4BIT_TILES);
+	S9xResetTileCache();
+}
+
+// Forget every converted tile. Stamps are sums of two page generations, so
+// with each page at 1 a zeroed stamp never matches.
+void S9xResetTileCache (void)
+{
+	static const uint32	count[7] = { MAX_2BIT_TILES, MAX_4BIT_TILES, MAX_8BIT_TILES, MAX_2BIT_TILES, MAX_2BIT_TILES, MAX_4BIT_TILES, MAX_4BIT_TILES };
+
+	for (int t = 0; t < 7; t++)
+		memset(IPPU.TileStamp[t], 0, count[t] * sizeof(uint32));
+
+	for (int p = 0; p < VRAM_PAGES; p++)
+		IPPU.VRAMPageGen[p] = 1;
 }
 
 void S9xSoftResetPPU (void)
@@ -1881,13 +1895,7 @@ void S9xSoftResetPPU (void)
 		memset(&IPPU.Clip[c], 0, sizeof(struct ClipData));
 	IPPU.ColorsChanged = true;
 	IPPU.OBJChanged = true;
-	memset(IPPU.TileCached[TILE_2BIT], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_8BIT], 0, MAX_8BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_EVEN], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_ODD], 0,  MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_EVEN], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_ODD], 0,  MAX_4BIT_TILES);
+	S9xResetTileCache();
 	PPU.VRAMReadBuffer = 0; // XXX: FIXME: anything better?
 	GFX.DoInterlace = 0;
 	IPPU.Interlace = false;
@@ -1896,6 +1904,7 @@ void S9xSoftResetPPU (void)
 	IPPU.DoubleHeightPixels = false;
 	IPPU.CurrentLine = 0;
 	IPPU.PreviousLine = 0;
+	GFX.DeferredBands = 0;
 	IPPU.XB = nullptr;
 	for (int c = 0; c < 256; c++)
 		IPPU.ScreenColors[c] = c;
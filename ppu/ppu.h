@@ -23,6 +23,9 @@
 #define MAX_4BIT_TILES		2048
 #define MAX_8BIT_TILES		1024
 
+#define VRAM_PAGE_SHIFT		6
+#define VRAM_PAGES			(0x10000 >> VRAM_PAGE_SHIFT)
+
 #define CLIP_OR				0
 #define CLIP_AND			1
 #define CLIP_XOR			2
@@ -41,8 +44,11 @@ struct InternalPPU
 	struct ClipData Clip[2][6];
 	bool8	ColorsChanged;
 	bool8	OBJChanged;
+	uint32	OBJSpriteChanged[4];	// sprites whose position, size or VFlip changed since SetupOBJ
 	uint8	*TileCache[7];
-	uint8	*TileCached[7];
+	uint8	*TileCached[7];		// BLANK_TILE or true, valid while the tile's TileStamp is current
+	uint32	*TileStamp[7];		// sum of the VRAMPageGen entries the tile was converted from
+	uint32	VRAMPageGen[VRAM_PAGES];	// bumped by every write to a 64-byte page of VRAM
 	bool8	Interlace;
 	bool8	InterlaceOBJ;
 	bool8	PseudoHires;
@@ -203,6 +209,7 @@ extern struct InternalPPU	IPPU;
 
 void S9xResetPPU (void);
 void S9xResetPPUFast (void);
+void S9xResetTileCache (void);
 void S9xSoftResetPPU (void);
 void S9xSetPPU (uint8, uint16);
 uint8 S9xGetPPU (uint16);
@@ -232,10 +239,24 @@ extern SnesModel	M2SNES;
 #define MAX_5A22_VERSION	0x02
 
 void S9xUpdateScreen (void);
+void S9xDeferScreen (void);
+void S9xRenderDeferred (void);
 static inline void FLUSH_REDRAW (void)
 {
 	if (IPPU.PreviousLine != IPPU.CurrentLine)
-		S9xUpdateScreen();
+	{
+		if (Settings.DeferredRendering)
+			S9xDeferScreen();
+		else
+			S9xUpdateScreen();
+	}
+}
+
+// Draw the bands FLUSH_REDRAW has queued, before state they don't capture changes.
+static inline void FLUSH_DEFERRED (void)
+{
+	if (GFX.DeferredBands)
+		S9xRenderDeferred();
 }
 
 static inline void S9xUpdateVRAMReadBuffer()
@@ -266,7 +287,7 @@ static inline void REGISTER_2104 (uint8 Byte)
 		{
 			FLUSH_REDRAW();
 			PPU.OAMData[addr] = Byte;
-			IPPU.OBJChanged = true;
+			IPPU.OBJSpriteChanged[(addr & 0x1f) >> 3] |= 0xfu << ((addr & 7) << 2);
 
 			// X position high bit, and sprite size (x4)
 			struct SOBJ *pObj = &PPU.OBJ[(addr & 0x1f) * 4];
@@ -294,11 +315,13 @@ static inline void REGISTER_2104 (uint8 Byte)
 			FLUSH_REDRAW();
 			PPU.OAMData[addr] = lowbyte;
 			PPU.OAMData[addr + 1] = highbyte;
-			IPPU.OBJChanged = true;
 			if (addr & 2)
 			{
 				// Tile
 				PPU.OBJ[addr = PPU.OAMAddr >> 1].Name = PPU.OAMWriteRegister & 0x1ff;
+				// Only VFlip moves the sprite in the OBJ line lists.
+				if (PPU.OBJ[addr].VFlip != ((highbyte >> 7) & 1))
+					IPPU.OBJSpriteChanged[addr >> 5] |= 1u << (addr & 31);
 				// priority, h and v flip.
 				PPU.OBJ[addr].Palette  = (highbyte >> 1) & 7;
 				PPU.OBJ[addr].Priority = (highbyte >> 4) & 3;
@@ -312,6 +335,7 @@ static inline void REGISTER_2104 (uint8 Byte)
 				PPU.OBJ[addr].HPos |= lowbyte;
 				// Sprite Y position
 				PPU.OBJ[addr].VPos = highbyte;
+				IPPU.OBJSpriteChanged[addr >> 5] |= 1u << (addr & 31);
 			}
 		}
 	}
@@ -370,17 +394,7 @@ static inline void REGISTER_2118 (uint8 Byte)
 	else
 		Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = false;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = false;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
+	IPPU.VRAMPageGen[address >> VRAM_PAGE_SHIFT]++;
 
 	if (!PPU.VMA.High)
 	{
@@ -401,17 +415,7 @@ static inline void REGISTER_2118_tile (uint8 Byte)
 
 	Memory.VRAM[address] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = false;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = false;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
+	IPPU.VRAMPageGen[address >> VRAM_PAGE_SHIFT]++;
 
 	if (!PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -425,17 +429,7 @@ static inline void REGISTER_2118_linear (uint8 Byte)
 
 	Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = false;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = false;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
+	IPPU.VRAMPageGen[address >> VRAM_PAGE_SHIFT]++;
 
 	if (!PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -477,17 +471,7 @@ static inline void REGISTER_2119 (uint8 Byte)
 	else
 		Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = false;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = false;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
+	IPPU.VRAMPageGen[address >> VRAM_PAGE_SHIFT]++;
 
 	if (PPU.VMA.High)
 	{
@@ -508,17 +492,7 @@ static inline void REGISTER_2119_tile (uint8 Byte)
 
 	Memory.VRAM[address] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = false;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = false;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
+	IPPU.VRAMPageGen[address >> VRAM_PAGE_SHIFT]++;
 
 	if (PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -532,22 +506,22 @@ static inline void REGISTER_2119_linear (uint8 Byte)
 
 	Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = false;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = false;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = false;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = false;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = false;
+	IPPU.VRAMPageGen[address >> VRAM_PAGE_SHIFT]++;
 
 	if (PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
 }
 
+// The page bumps REGISTER_2118/2119 do per byte, for VRAM bytes
+// [address, address + length), which must not wrap past $ffff.
+static inline void S9xInvalidateTileRange (uint32 address, uint32 length)
+{
+	uint32	last = (address + length - 1) >> VRAM_PAGE_SHIFT;
+
+	for (uint32 page = address >> VRAM_PAGE_SHIFT; page <= last; page++)
+		IPPU.VRAMPageGen[page]++;
+}
+
 static inline void REGISTER_2122 (uint8 Byte)
 {
 	if (PPU.CGFLIP)
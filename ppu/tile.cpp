@@ -305,6 +305,15 @@ extern template struct TileImpl::Renderers<DrawMode7MosaicBG1, Normal1x1>;
 extern template struct TileImpl::Renderers<DrawMode7BG1, Normal1x1>;
 extern template struct TileImpl::Renderers<DrawMode7MosaicBG2, Normal1x1>;
 extern template struct TileImpl::Renderers<DrawMode7BG2, Normal1x1>;
+extern template struct TileImpl::Renderers<DrawTile16, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawClippedTile16, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawMosaicPixel16, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawBackdrop16, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawMode7MosaicBG1, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawMode7BG1, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawMode7MosaicBG2, Deferred1x1>;
+extern template struct TileImpl::Renderers<DrawMode7BG2, Deferred1x1>;
+extern template struct TileImpl::Renderers<ComposeSpan16, Deferred1x1>;
 
 extern template struct TileImpl::Renderers<DrawTile16, Normal2x1>;
 extern template struct TileImpl::Renderers<DrawClippedTile16, Normal2x1>;
@@ -346,7 +355,44 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 	bool8 interlace = obj ? false : IPPU.Interlace;
 	bool8 hires = !sub && (BGMode == 5 || BGMode == 6 || IPPU.PseudoHires);
 
-	if (!IPPU.DoubleWidthPixels)	// normal width
+	int	i;
+
+	if (!Settings.Transparency)
+		i = 0;
+	else
+	{
+		i = (Memory.FillRAM[0x2131] & 0x80) ? 4 : 1;
+		if (Memory.FillRAM[0x2131] & 0x40)
+		{
+			i++;
+			if (Memory.FillRAM[0x2130] & 2)
+				i++;
+		}
+		if (IPPU.MaxBrightness != 0xf)
+		{
+			if (i == 1)
+				i = 7;
+			else if (i == 3)
+				i = 8;
+		}
+
+	}
+
+	GFX.DeferredMath = false;
+
+	if (!IPPU.DoubleWidthPixels && !sub && i)	// normal width, colour math applied by ComposeMath
+	{
+		DT     = Renderers<DrawTile16, Deferred1x1>::Functions;
+		DCT    = Renderers<DrawClippedTile16, Deferred1x1>::Functions;
+		DMP    = Renderers<DrawMosaicPixel16, Deferred1x1>::Functions;
+		DB     = Renderers<DrawBackdrop16, Deferred1x1>::Functions;
+		DM7BG1 = M7M1 ? Renderers<DrawMode7MosaicBG1, Deferred1x1>::Functions : Renderers<DrawMode7BG1, Deferred1x1>::Functions;
+		DM7BG2 = M7M2 ? Renderers<DrawMode7MosaicBG2, Deferred1x1>::Functions : Renderers<DrawMode7BG2, Deferred1x1>::Functions;
+		GFX.LinesPerTile = 8;
+		GFX.ComposeMath  = Renderers<ComposeSpan16, Deferred1x1>::Functions[i];
+		GFX.DeferredMath = true;
+	}
+	else if (!IPPU.DoubleWidthPixels)	// normal width
 	{
 		DT     = Renderers<DrawTile16, Normal1x1>::Functions;
 		DCT    = Renderers<DrawClippedTile16, Normal1x1>::Functions;
@@ -410,29 +456,6 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 	GFX.DrawMode7BG1Nomath    = DM7BG1[0];
 	GFX.DrawMode7BG2Nomath    = DM7BG2[0];
 
-	int	i;
-
-	if (!Settings.Transparency)
-		i = 0;
-	else
-	{
-		i = (Memory.FillRAM[0x2131] & 0x80) ? 4 : 1;
-		if (Memory.FillRAM[0x2131] & 0x40)
-		{
-			i++;
-			if (Memory.FillRAM[0x2130] & 2)
-				i++;
-		}
-		if (IPPU.MaxBrightness != 0xf)
-		{
-			if (i == 1)
-				i = 7;
-			else if (i == 3)
-				i = 8;
-		}
-
-	}
-
 	GFX.DrawTileMath        = DT[i];
 	GFX.DrawClippedTileMath = DCT[i];
 	GFX.DrawMosaicPixelMath = DMP[i];
@@ -449,6 +472,8 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 			BG.ConvertTile      = BG.ConvertTileFlip = ConvertTile8;
 			BG.Buffer           = BG.BufferFlip      = IPPU.TileCache[TILE_8BIT];
 			BG.Buffered         = BG.BufferedFlip    = IPPU.TileCached[TILE_8BIT];
+			BG.Stamp            = BG.StampFlip       = IPPU.TileStamp[TILE_8BIT];
+			BG.PairedTiles      = false;
 			BG.TileShift        = 6;
 			BG.PaletteShift     = 0;
 			BG.PaletteMask      = 0;
@@ -464,18 +489,22 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 					BG.ConvertTile     = ConvertTile4h_even;
 					BG.Buffer          = IPPU.TileCache[TILE_4BIT_EVEN];
 					BG.Buffered        = IPPU.TileCached[TILE_4BIT_EVEN];
+					BG.Stamp           = IPPU.TileStamp[TILE_4BIT_EVEN];
 					BG.ConvertTileFlip = ConvertTile4h_odd;
 					BG.BufferFlip      = IPPU.TileCache[TILE_4BIT_ODD];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT_ODD];
+					BG.StampFlip       = IPPU.TileStamp[TILE_4BIT_ODD];
 				}
 				else
 				{
 					BG.ConvertTile     = ConvertTile4h_odd;
 					BG.Buffer          = IPPU.TileCache[TILE_4BIT_ODD];
 					BG.Buffered        = IPPU.TileCached[TILE_4BIT_ODD];
+					BG.Stamp           = IPPU.TileStamp[TILE_4BIT_ODD];
 					BG.ConvertTileFlip = ConvertTile4h_even;
 					BG.BufferFlip      = IPPU.TileCache[TILE_4BIT_EVEN];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT_EVEN];
+					BG.StampFlip       = IPPU.TileStamp[TILE_4BIT_EVEN];
 				}
 			}
 			else
@@ -483,8 +512,10 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 				BG.ConvertTile = BG.ConvertTileFlip = ConvertTile4;
 				BG.Buffer      = BG.BufferFlip      = IPPU.TileCache[TILE_4BIT];
 				BG.Buffered    = BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT];
+				BG.Stamp       = BG.StampFlip       = IPPU.TileStamp[TILE_4BIT];
 			}
 
+			BG.PairedTiles      = hires;
 			BG.TileShift        = 5;
 			BG.PaletteShift     = 10 - 4;
 			BG.PaletteMask      = 7 << 4;
@@ -500,18 +531,22 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 					BG.ConvertTile     = ConvertTile2h_even;
 					BG.Buffer          = IPPU.TileCache[TILE_2BIT_EVEN];
 					BG.Buffered        = IPPU.TileCached[TILE_2BIT_EVEN];
+					BG.Stamp           = IPPU.TileStamp[TILE_2BIT_EVEN];
 					BG.ConvertTileFlip = ConvertTile2h_odd;
 					BG.BufferFlip      = IPPU.TileCache[TILE_2BIT_ODD];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT_ODD];
+					BG.StampFlip       = IPPU.TileStamp[TILE_2BIT_ODD];
 				}
 				else
 				{
 					BG.ConvertTile     = ConvertTile2h_odd;
 					BG.Buffer          = IPPU.TileCache[TILE_2BIT_ODD];
 					BG.Buffered        = IPPU.TileCached[TILE_2BIT_ODD];
+					BG.Stamp           = IPPU.TileStamp[TILE_2BIT_ODD];
 					BG.ConvertTileFlip = ConvertTile2h_even;
 					BG.BufferFlip      = IPPU.TileCache[TILE_2BIT_EVEN];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT_EVEN];
+					BG.StampFlip       = IPPU.TileStamp[TILE_2BIT_EVEN];
 				}
 			}
 			else
@@ -519,8 +554,10 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 				BG.ConvertTile = BG.ConvertTileFlip = ConvertTile2;
 				BG.Buffer      = BG.BufferFlip      = IPPU.TileCache[TILE_2BIT];
 				BG.Buffered    = BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT];
+				BG.Stamp       = BG.StampFlip       = IPPU.TileStamp[TILE_2BIT];
 			}
 
+			BG.PairedTiles      = hires;
 			BG.TileShift        = 4;
 			BG.PaletteShift     = 10 - 2;
 			BG.PaletteMask      = 7 << 2;
@@ -21,6 +21,35 @@ namespace TileImpl {
 	}
 
 
+	template<class MATH, class BPSTART>
+	void Deferred1x1Base<MATH, BPSTART>::Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2)
+	{
+		(void) OffsetInLine;
+		if (Z1 > GFX.DB[Offset + N] && (M))
+		{
+			GFX.S[Offset + N] = GFX.ScreenColors[Pix];
+			GFX.DB[Offset + N] = Z2;
+			GFX.MathBuffer[Offset + N] = MathFlags<MATH>::Get();
+		}
+	}
+
+	template<class MATH, class BPSTART>
+	void Deferred1x1Base<MATH, BPSTART>::Compose(uint32 Offset, uint32 Width)
+	{
+		uint16	*S    = GFX.S + Offset;
+		uint16	*Sub  = GFX.SubScreen + Offset;
+		uint8	*SubZ = GFX.SubZBuffer + Offset;
+		uint8	*Flag = GFX.MathBuffer + Offset;
+
+		// Branchless so the packed-RGB add/sub/halve operators vectorise across the span.
+		for (uint32 x = 0; x < Width; x++)
+		{
+			uint16	Math = MATH::Calc(S[x], Sub[x], SubZ[x], (Flag[x] & 2) != 0);
+			S[x] = (Flag[x] & 1) ? Math : S[x];
+		}
+	}
+
+
 	// normal width
 	template struct Renderers<DrawTile16, Normal1x1>;
 	template struct Renderers<DrawClippedTile16, Normal1x1>;
@@ -31,4 +60,15 @@ namespace TileImpl {
 	template struct Renderers<DrawMode7MosaicBG2, Normal1x1>;
 	template struct Renderers<DrawMode7BG2, Normal1x1>;
 
+	// normal width, deferred colour math
+	template struct Renderers<DrawTile16, Deferred1x1>;
+	template struct Renderers<DrawClippedTile16, Deferred1x1>;
+	template struct Renderers<DrawMosaicPixel16, Deferred1x1>;
+	template struct Renderers<DrawBackdrop16, Deferred1x1>;
+	template struct Renderers<DrawMode7MosaicBG1, Deferred1x1>;
+	template struct Renderers<DrawMode7BG1, Deferred1x1>;
+	template struct Renderers<DrawMode7MosaicBG2, Deferred1x1>;
+	template struct Renderers<DrawMode7BG2, Deferred1x1>;
+	template struct Renderers<ComposeSpan16, Deferred1x1>;
+
 } // namespace TileImpl
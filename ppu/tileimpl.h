@@ -83,6 +83,26 @@ namespace TileImpl {
 	struct HiresInterlace : public HiresBase<MATH, BPInterlace> {};
 
 
+	// The deferred 1x1 pixel plotter, for the main screen of normal width frames with colour math enabled.
+	// Layers are composited with the Z-buffer as usual, but only the main screen colour is written, together
+	// with a per-pixel math record in GFX.MathBuffer. Once every layer has been drawn, Compose() applies the
+	// selected colour math across whole line spans. The result is the same as applying MATH at plot time,
+	// since only the topmost pixel survives either way, but each pixel is mathed once instead of on every
+	// overdraw and the span loop carries no Z-buffer dependencies.
+	template<class MATH, class BPSTART>
+	struct Deferred1x1Base
+	{
+		enum { Pitch = BPSTART::Pitch };
+		typedef BPSTART bpstart_t;
+
+		static void Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
+		static void Compose(uint32 Offset, uint32 Width);
+	};
+
+	template<class MATH>
+	struct Deferred1x1 : public Deferred1x1Base<MATH, BPProgressive> {};
+
+
 	class CachedTile
 	{
 	public:
@@ -95,17 +115,31 @@ namespace TileImpl {
 				TileAddr += BG.NameSelect;
 			TileAddr &= 0xffff;
 			TileNumber = TileAddr >> BG.TileShift;
+
+			// A cached tile is current while the VRAM pages it was converted
+			// from haven't been written; hires tiles also read the next tile.
+			uint32	NextAddr = TileAddr;
+			if (BG.PairedTiles)
+				NextAddr = ((Tile & 0x3ff) == 0x3ff ? TileAddr - (0x3ff << BG.TileShift) : TileAddr + (1 << BG.TileShift)) & 0xffff;
+			uint32	Stamp = IPPU.VRAMPageGen[TileAddr >> VRAM_PAGE_SHIFT] + IPPU.VRAMPageGen[NextAddr >> VRAM_PAGE_SHIFT];
+
 			if (Tile & H_FLIP)
 			{
 				pCache = &BG.BufferFlip[TileNumber << 6];
-				if (!BG.BufferedFlip[TileNumber])
+				if (BG.StampFlip[TileNumber] != Stamp)
+				{
+					BG.StampFlip[TileNumber] = Stamp;
 					BG.BufferedFlip[TileNumber] = BG.ConvertTileFlip(pCache, TileAddr, Tile & 0x3ff);
+				}
 			}
 			else
 			{
 				pCache = &BG.Buffer[TileNumber << 6];
-				if (!BG.Buffered[TileNumber])
+				if (BG.Stamp[TileNumber] != Stamp)
+				{
+					BG.Stamp[TileNumber] = Stamp;
 					BG.Buffered[TileNumber] = BG.ConvertTile(pCache, TileAddr, Tile & 0x3ff);
+				}
 			}
 		}
 
@@ -138,8 +172,17 @@ namespace TileImpl {
 	};
 
 
+	// Colour math operators. Calc() takes the clip-colours state explicitly so the
+	// deferred compositor can evaluate a whole span with per-pixel clip state; the
+	// three-argument form used by the plotters reads GFX.ClipColors as before.
+
 	struct NOMATH
 	{
+		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD, bool8 ClipColors)
+		{
+			return Main;
+		}
+
 		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
 		{
 			return Main;
@@ -150,10 +193,15 @@ namespace TileImpl {
 	template<class Op>
 	struct REGMATH
 	{
-		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
+		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD, bool8 ClipColors)
 		{
 			return Op::fn(Main, (SD & 0x20) ? Sub : GFX.FixedColour);
 		}
+
+		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
+		{
+			return Calc(Main, Sub, SD, GFX.ClipColors);
+		}
 	};
 	typedef REGMATH<COLOR_ADD> Blend_Add;
 	typedef REGMATH<COLOR_SUB> Blend_Sub;
@@ -162,9 +210,14 @@ namespace TileImpl {
 	template<class Op>
 	struct MATHF1_2
 	{
+		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD, bool8 ClipColors)
+		{
+			return ClipColors ? Op::fn(Main, GFX.FixedColour) : Op::fn1_2(Main, GFX.FixedColour);
+		}
+
 		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
 		{
-			return GFX.ClipColors ? Op::fn(Main, GFX.FixedColour) : Op::fn1_2(Main, GFX.FixedColour);
+			return Calc(Main, Sub, SD, GFX.ClipColors);
 		}
 	};
 	typedef MATHF1_2<COLOR_ADD> Blend_AddF1_2;
@@ -173,15 +226,33 @@ namespace TileImpl {
 	template<class Op>
 	struct MATHS1_2
 	{
+		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD, bool8 ClipColors)
+		{
+			return ClipColors ? REGMATH<Op>::Calc(Main, Sub, SD, ClipColors) : (SD & 0x20) ? Op::fn1_2(Main, Sub) : Op::fn(Main, GFX.FixedColour);
+		}
+
 		static alwaysinline uint16 Calc(uint16 Main, uint16 Sub, uint8 SD)
 		{
-			return GFX.ClipColors ? REGMATH<Op>::Calc(Main, Sub, SD) : (SD & 0x20) ? Op::fn1_2(Main, Sub) : Op::fn(Main, GFX.FixedColour);
+			return Calc(Main, Sub, SD, GFX.ClipColors);
 		}
 	};
 	typedef MATHS1_2<COLOR_ADD> Blend_AddS1_2;
 	typedef MATHS1_2<COLOR_SUB> Blend_SubS1_2;
 	typedef MATHS1_2<COLOR_ADD_BRIGHTNESS> Blend_AddS1_2Brightness;
 
+	// Per-pixel record left by the deferred plotter: bit 0 = apply math, bit 1 = clip colours.
+	template<class MATH>
+	struct MathFlags
+	{
+		static alwaysinline uint8 Get() { return 1 | (GFX.ClipColors ? 2 : 0); }
+	};
+
+	template<>
+	struct MathFlags<NOMATH>
+	{
+		static alwaysinline uint8 Get() { return 0; }
+	};
+
 	template<
 		template<class PIXEL_> class TILE,
 		template<class MATH> class PIXEL
@@ -497,6 +568,21 @@ namespace TileImpl {
 	#undef Z2
 	#undef DRAW_PIXEL
 
+	// Applies deferred colour math to lines GFX.StartY..GFX.EndY of the main screen.
+	// Only meaningful with a PIXEL that implements Compose() (Deferred1x1).
+
+	template<class PIXEL>
+	struct ComposeSpan16
+	{
+		typedef void (*call_t)(uint32 Offset, uint32 Width);
+
+		static void Draw(uint32 Offset, uint32 Width)
+		{
+			for (uint32 l = GFX.StartY; l <= GFX.EndY; l++, Offset += GFX.PPL)
+				PIXEL::Compose(Offset, Width);
+		}
+	};
+
 	// Basic routine to render a chunk of a Mode 7 BG.
 	// Mode 7 has no interlace, so bpstart_t and Pitch are unused.
 	// We get some new parameters, so we can use the same DRAW_TILE to do BG1 or BG2:
@@ -530,11 +616,19 @@ namespace TileImpl {
 		static uint8 DCMODE() { return 0; }
 	};
 
+	// Non-mosaic Mode 7 is rasterised in spans of M7_SPAN pixels: the affine
+	// coordinates for the whole span are stepped first, then the tile map and
+	// character bytes are gathered, and only then are the pixels plotted.
+	// Keeping each stage in its own fixed-length loop lets the compiler
+	// vectorise the coordinate maths and keeps the VRAM gathers clear of the
+	// plotter's Z-buffer traffic. Mosaic keeps the per-pixel path below.
 	template<class PIXEL, class OP>
 	struct DrawTileNormal
 	{
 		typedef void (*call_t)(uint32 Left, uint32 Right, int D);
 
+		enum { M7_SPAN = 16 };
+
 		static void Draw(uint32 Left, uint32 Right, int D)
 		{
 			uint8	*VRAM1 = Memory.VRAM + 1;
@@ -593,41 +687,50 @@ namespace TileImpl {
 				int	CC = l->MatrixC * startx + ((l->MatrixC * xx) & ~63);
 
 				uint8	Pix;
+				uint8	Texels[M7_SPAN];
+				int		X[M7_SPAN], Y[M7_SPAN];
 
-				if (!PPU.Mode7Repeat)
+				for (uint32 x = Left; x < Right; x += M7_SPAN, AA += aa * M7_SPAN, CC += cc * M7_SPAN)
 				{
-					for (uint32 x = Left; x < Right; x++, AA += aa, CC += cc)
+					uint32	n = (Right - x < (uint32) M7_SPAN) ? Right - x : (uint32) M7_SPAN;
+
+					for (int i = 0; i < M7_SPAN; i++)
 					{
-						int	X = ((AA + BB) >> 8) & 0x3ff;
-						int	Y = ((CC + DD) >> 8) & 0x3ff;
+						X[i] = (AA + aa * i + BB) >> 8;
+						Y[i] = (CC + cc * i + DD) >> 8;
+					}
 
-						uint8	*TileData = VRAM1 + (Memory.VRAM[((Y & ~7) << 5) + ((X >> 2) & ~1)] << 7);
-						uint8	b = *(TileData + ((Y & 7) << 4) + ((X & 7) << 1));
+					if (!PPU.Mode7Repeat)
+					{
+						for (int i = 0; i < M7_SPAN; i++)
+						{
+							X[i] &= 0x3ff;
+							Y[i] &= 0x3ff;
+						}
 
-						Pix = b & OP::MASK; DRAW_PIXEL(x, Pix);
+						for (uint32 i = 0; i < n; i++)
+							Texels[i] = VRAM1[(Memory.VRAM[((Y[i] & ~7) << 5) + ((X[i] >> 2) & ~1)] << 7) + ((Y[i] & 7) << 4) + ((X[i] & 7) << 1)];
 					}
-				}
-				else
-				{
-					for (uint32 x = Left; x < Right; x++, AA += aa, CC += cc)
+					else
 					{
-						int	X = ((AA + BB) >> 8);
-						int	Y = ((CC + DD) >> 8);
-
-						uint8	b;
-
-						if (((X | Y) & ~0x3ff) == 0)
+						// Outside the 1024x1024 playfield: tile 0 for repeat mode 3,
+						// transparent otherwise.
+						for (uint32 i = 0; i < n; i++)
 						{
-							uint8	*TileData = VRAM1 + (Memory.VRAM[((Y & ~7) << 5) + ((X >> 2) & ~1)] << 7);
-							b = *(TileData + ((Y & 7) << 4) + ((X & 7) << 1));
+							if (((X[i] | Y[i]) & ~0x3ff) == 0)
+								Texels[i] = VRAM1[(Memory.VRAM[((Y[i] & ~7) << 5) + ((X[i] >> 2) & ~1)] << 7) + ((Y[i] & 7) << 4) + ((X[i] & 7) << 1)];
+							else
+							if (PPU.Mode7Repeat == 3)
+								Texels[i] = VRAM1[((Y[i] & 7) << 4) + ((X[i] & 7) << 1)];
+							else
+								Texels[i] = 0;
 						}
-						else
-						if (PPU.Mode7Repeat == 3)
-							b = *(VRAM1    + ((Y & 7) << 4) + ((X & 7) << 1));
-						else
-							continue;
+					}
 
-						Pix = b & OP::MASK; DRAW_PIXEL(x, Pix);
+					for (uint32 i = 0; i < n; i++)
+					{
+						uint8	b = Texels[i];
+						Pix = b & OP::MASK; DRAW_PIXEL(x + i, Pix);
 					}
 				}
 			}
@@ -303,6 +303,8 @@ struct SSettings
 	uint8	BG_Forced;
 	bool8	DisableGraphicWindows;
 	uint16  ForcedBackdrop;
+	bool8	DeferredRendering;
+	bool8	NativeLineWidth;
 
 	bool8	AutoDisplayMessages;
 	uint32	InitialInfoStringTimeout;
@@ -334,6 +336,8 @@ struct SSettings
 	bool8	DontSaveOopsSnapshot;
 
     bool8   SeparateEchoBuffer;
+	bool8	FastDSP;
+	bool8	IdleLoopSkip;
 	uint32	SuperFXClockMultiplier;
 	int	OneClockCycle;
 	int	OneSlowClockCycle;
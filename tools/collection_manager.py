@@ -20,6 +20,30 @@ MAX_SNES_WIDTH = 512
 SNES_START_MASK = 1 << 12
 
 
+class ROMProbe(ctypes.Structure):
+    """Mirror of SROMProbe (mem/romprobe.h)."""
+    _fields_ = [
+        ("name", ctypes.c_char * 23),
+        ("rom_id", ctypes.c_char * 5),
+        ("map_type", ctypes.c_char * 8),
+        ("contents", ctypes.c_char * 24),
+        ("file_size", ctypes.c_uint32),
+        ("rom_size", ctypes.c_uint32),
+        ("checksum", ctypes.c_uint16),
+        ("complement_checksum", ctypes.c_uint16),
+        ("map_mode", ctypes.c_uint8),
+        ("cart_type", ctypes.c_uint8),
+        ("rom_size_code", ctypes.c_uint8),
+        ("sram_size_code", ctypes.c_uint8),
+        ("region", ctypes.c_uint8),
+        ("version", ctypes.c_uint8),
+        ("valid", ctypes.c_bool),
+        ("pal", ctypes.c_bool),
+        ("copier_header", ctypes.c_bool),
+        ("interleaved", ctypes.c_bool),
+    ]
+
+
 def load_library(lib_path: Path):
     lib = ctypes.CDLL(str(lib_path))
 
@@ -36,10 +60,23 @@ def load_library(lib_path: Path):
     lib.emu_is_pal.restype = ctypes.c_bool
     lib.emu_set_buttons.argtypes = [ctypes.c_int, ctypes.c_uint16]
     lib.emu_set_buttons.restype = None
+    lib.emu_probe_dir.argtypes = [ctypes.c_char_p, ctypes.c_bool, ctypes.c_int]
+    lib.emu_probe_dir.restype = ctypes.c_int
+    lib.emu_probe_results.restype = ctypes.POINTER(ROMProbe)
+    lib.emu_probe_path.argtypes = [ctypes.c_int]
+    lib.emu_probe_path.restype = ctypes.c_char_p
 
     return lib
 
 
+def probe_roms(lib, rom_directory: Path) -> list[tuple[Path, ROMProbe]]:
+    """Read every ROM header under rom_directory without loading anything."""
+    count = lib.emu_probe_dir(str(rom_directory).encode(), True, 0)
+    results = lib.emu_probe_results()
+    return [(Path(lib.emu_probe_path(i).decode()), ROMProbe.from_buffer_copy(results[i]))
+            for i in range(count)]
+
+
 def framebuffer_hash(lib) -> bytes:
     """Hash the visible portion of the framebuffer."""
     w, h = lib.emu_frame_width(), lib.emu_frame_height()
@@ -196,7 +233,7 @@ def capture_fixed(lib, seconds: float):
     return capture_screenshot(lib), f"fixed {seconds}s"
 
 
-def process_rom(lib, rom_path: Path, output_dir: Path, copy_rom: bool,
+def process_rom(lib, rom_path: Path, probe: ROMProbe, output_dir: Path, copy_rom: bool,
                 overrides: dict[str, float] | None = None) -> dict | None:
     if not lib.emu_load_rom(str(rom_path).encode()):
         print(f"  SKIP: failed to load {rom_path.name}", file=sys.stderr)
@@ -230,6 +267,9 @@ def process_rom(lib, rom_path: Path, output_dir: Path, copy_rom: bool,
         "game_name": name,
         "filename": safe_name,
         "region": "PAL" if is_pal else "NTSC",
+        "map_type": probe.map_type.decode(),
+        "contents": probe.contents.decode(),
+        "checksum": f"{probe.checksum:04x}",
         "screenshot_strategy": strategy,
     }
 
@@ -258,14 +298,17 @@ def main():
 
     args.output_dir.mkdir(parents=True, exist_ok=True)
 
-    roms = sorted(args.rom_directory.rglob("*.sfc"))
+    roms = probe_roms(lib, args.rom_directory)
     print(f"Found {len(roms)} ROMs")
     if overrides:
         print(f"Overrides: {overrides}")
 
     results = []
-    for rom in roms:
-        info = process_rom(lib, rom, args.output_dir, args.copy_roms, overrides)
+    for rom, probe in roms:
+        if not probe.valid:
+            print(f"  SKIP: no SNES header in {rom.name}", file=sys.stderr)
+            continue
+        info = process_rom(lib, rom, probe, args.output_dir, args.copy_roms, overrides)
         if info:
             results.append(info)
 
@@ -0,0 +1,987 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+               This file is licensed under the Snes9x License.
+  For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+// snes9x-covers: capture title screens for a ROM collection in parallel.
+//
+// Native counterpart of tools/collection_manager.py. The core keeps all of its
+// state in globals, so the parallelism is one worker process per core. Each
+// worker calls Emulator::Init() once and then LoadROM() for every game it
+// takes from a shared counter. Workers report through a shared-memory table,
+// and the parent writes metadata.json in the same layout as the Python tool.
+
+#include "snes9x.h"
+#include "memmap.h"
+#include "romprobe.h"
+#include "gfx.h"
+#include "common/config.h"
+#include "platform/shared/emulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Shared work table
+// ---------------------------------------------------------------------------
+
+enum { JOB_PENDING, JOB_RUNNING, JOB_DONE, JOB_FAILED, JOB_CRASHED };
+
+struct Job {
+    std::atomic<int> state;
+    pid_t worker;
+    bool  reported;             // Parent only
+    bool  pal;
+    char  name[ROM_NAME_LEN];
+    char  filename[64];
+    char  strategy[96];
+};
+
+struct WorkTable {
+    std::atomic<int> next;      // Next job to hand out
+    Job jobs[1];
+};
+
+struct Options {
+    std::string output_dir = "./output";
+    std::string config;
+    bool copy_roms = false;
+    bool verbose = false;
+    int workers = 0;
+    std::vector<std::pair<std::string, double>> overrides;
+};
+
+// ---------------------------------------------------------------------------
+// PNG output (fixed-Huffman deflate, no zlib needed)
+// ---------------------------------------------------------------------------
+
+struct BitWriter {
+    std::vector<uint8_t> &out;
+    uint32_t bits = 0;
+    int count = 0;
+
+    explicit BitWriter(std::vector<uint8_t> &o) : out(o) {}
+
+    void put(uint32_t value, int length)
+    {
+        bits |= value << count;
+        count += length;
+        while (count >= 8)
+        {
+            out.push_back(bits & 0xff);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes go out most significant bit first
+    void code(uint32_t value, int length)
+    {
+        uint32_t r = 0;
+        for (int i = 0; i < length; i++)
+            r |= ((value >> i) & 1) << (length - 1 - i);
+        put(r, length);
+    }
+
+    void flush()
+    {
+        if (count)
+            out.push_back(bits & 0xff);
+        bits = 0;
+        count = 0;
+    }
+};
+
+static void put_symbol(BitWriter &bw, int symbol)
+{
+    if (symbol < 144)
+        bw.code(0x30 + symbol, 8);
+    else if (symbol < 256)
+        bw.code(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        bw.code(symbol - 256, 7);
+    else
+        bw.code(0xc0 + symbol - 280, 8);
+}
+
+static void put_match(BitWriter &bw, int length, int distance)
+{
+    static const uint16_t len_base[29]  = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const uint8_t  len_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const uint16_t dist_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                            8193, 12289, 16385, 24577 };
+    static const uint8_t  dist_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                             7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    int l = 28;
+    while (len_base[l] > length)
+        l--;
+    put_symbol(bw, 257 + l);
+    bw.put(length - len_base[l], len_extra[l]);
+
+    int d = 29;
+    while (dist_base[d] > distance)
+        d--;
+    bw.code(d, 5);
+    bw.put(distance - dist_base[d], dist_extra[d]);
+}
+
+// One fixed-Huffman block with greedy LZ77 matching; screenshots are mostly
+// flat colour and repeated tiles, which this handles well.
+static void deflate_fixed(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+{
+    const int WINDOW = 32768, MIN_MATCH = 3, MAX_MATCH = 258, MAX_CHAIN = 32;
+    const int HASH_BITS = 15;
+
+    std::vector<int32_t> head(1 << HASH_BITS, -1), prev(WINDOW, -1);
+    auto hash = [&](size_t i) {
+        return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & ((1 << HASH_BITS) - 1);
+    };
+    auto insert = [&](size_t i) {
+        if (i + MIN_MATCH > size)
+            return;
+        int h = hash(i);
+        prev[i % WINDOW] = head[h];
+        head[h] = (int32_t)i;
+    };
+
+    BitWriter bw(out);
+    bw.put(1, 1);   // BFINAL
+    bw.put(1, 2);   // Fixed Huffman codes
+
+    size_t i = 0;
+    while (i < size)
+    {
+        int best_len = 0, best_dist = 0;
+
+        if (i + MIN_MATCH <= size)
+        {
+            int32_t candidate = head[hash(i)];
+            int limit = (int)std::min<size_t>(MAX_MATCH, size - i);
+
+            for (int chain = 0; candidate >= 0 && i - candidate <= (size_t)WINDOW && chain < MAX_CHAIN; chain++)
+            {
+                int len = 0;
+                while (len < limit && data[candidate + len] == data[i + len])
+                    len++;
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_dist = (int)(i - candidate);
+                    if (len == limit)
+                        break;
+                }
+                int32_t next = prev[candidate % WINDOW];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+        }
+
+        if (best_len >= MIN_MATCH)
+        {
+            put_match(bw, best_len, best_dist);
+            for (int k = 0; k < best_len; k++)
+                insert(i + k);
+            i += best_len;
+        }
+        else
+        {
+            put_symbol(bw, data[i]);
+            insert(i);
+            i++;
+        }
+    }
+
+    put_symbol(bw, 256);
+    bw.flush();
+}
+
+static uint32_t crc32_png(const uint8_t *data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    if (!table[1])
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_be32(std::vector<uint8_t> &out, uint32_t v)
+{
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+static void put_chunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data)
+{
+    put_be32(png, (uint32_t)data.size());
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    put_be32(png, crc32_png(&png[start], png.size() - start));
+}
+
+// rgb is width * height * 3 bytes
+static bool write_png(const std::string &path, const uint8_t *rgb, int width, int height)
+{
+    // Filter each row with whichever of None/Sub/Up looks smallest
+    size_t stride = (size_t)width * 3;
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * height);
+
+    std::vector<uint8_t> row(stride);
+    for (int y = 0; y < height; y++)
+    {
+        const uint8_t *cur = rgb + y * stride;
+        const uint8_t *up  = y ? cur - stride : nullptr;
+        int best_type = 0;
+        uint32_t best_cost = UINT32_MAX;
+
+        for (int type = 0; type < 3; type++)
+        {
+            if (type == 2 && !up)
+                continue;
+            uint32_t cost = 0;
+            for (size_t x = 0; x < stride; x++)
+            {
+                uint8_t pred = type == 1 ? (x >= 3 ? cur[x - 3] : 0) : type == 2 ? up[x] : 0;
+                cost += std::abs((int8_t)(cur[x] - pred));
+            }
+            if (cost < best_cost)
+            {
+                best_cost = cost;
+                best_type = type;
+            }
+        }
+
+        raw.push_back(best_type);
+        for (size_t x = 0; x < stride; x++)
+        {
+            uint8_t pred = best_type == 1 ? (x >= 3 ? cur[x - 3] : 0) : best_type == 2 ? up[x] : 0;
+            raw.push_back(cur[x] - pred);
+        }
+    }
+
+    std::vector<uint8_t> zdata = { 0x78, 0x01 };
+    deflate_fixed(raw.data(), raw.size(), zdata);
+    uint32_t a = 1, b = 0;
+    for (uint8_t c : raw)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(zdata, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, width);
+    put_be32(ihdr, height);
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });     // 8-bit RGB
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    std::vector<uint8_t> png(signature, signature + 8);
+    put_chunk(png, "IHDR", ihdr);
+    put_chunk(png, "IDAT", zdata);
+    put_chunk(png, "IEND", {});
+
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+    return fclose(f) == 0 && ok;
+}
+
+// ---------------------------------------------------------------------------
+// Title-screen heuristic (capture_title_screen() in collection_manager.py)
+// ---------------------------------------------------------------------------
+
+struct Screen {
+    int width = 0, height = 0;
+    std::vector<uint8_t> rgb;
+};
+
+static uint64_t frame_hash()
+{
+    const uint16_t *fb = Emulator::GetFrameBuffer();
+    int w = Emulator::GetFrameWidth(), h = Emulator::GetFrameHeight();
+    uint64_t hash = 14695981039346656037ull;
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint8_t *row = (const uint8_t *)(fb + y * MAX_SNES_WIDTH);
+        for (int x = 0; x < w * 2; x++)
+            hash = (hash ^ row[x]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Number of distinct colours on screen; title screens have more than logos
+static int screen_complexity()
+{
+    static std::vector<uint64_t> seen(65536 / 64);
+    const uint16_t *fb = Emulator::GetFrameBuffer();
+    int w = Emulator::GetFrameWidth(), h = Emulator::GetFrameHeight();
+    int colors = 0;
+
+    std::fill(seen.begin(), seen.end(), 0);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            uint16_t p = fb[y * MAX_SNES_WIDTH + x];
+            uint64_t bit = 1ull << (p & 63);
+            if (!(seen[p >> 6] & bit))
+            {
+                seen[p >> 6] |= bit;
+                colors++;
+            }
+        }
+    }
+    return colors;
+}
+
+static Screen capture_screen()
+{
+    Screen s;
+    s.width = Emulator::GetFrameWidth();
+    s.height = Emulator::GetFrameHeight();
+    s.rgb.resize((size_t)s.width * s.height * 3);
+
+    const uint16_t *fb = Emulator::GetFrameBuffer();
+    uint8_t *out = s.rgb.data();
+    for (int y = 0; y < s.height; y++)
+    {
+        for (int x = 0; x < s.width; x++)
+        {
+            uint32 r, g, b;
+            DECOMPOSE_PIXEL(fb[y * MAX_SNES_WIDTH + x], r, g, b);
+            *out++ = (r & 0x1f) << 3;
+            *out++ = (g & 0x1f) << 3;
+            *out++ = (b & 0x1f) << 3;
+        }
+    }
+    return s;
+}
+
+static void run_frames(int frames)
+{
+    for (int i = 0; i < frames; i++)
+        Emulator::RunFrame();
+}
+
+struct Candidate {
+    Screen screen;
+    int complexity;
+    int frame;
+};
+
+// Run up to max_frames, keeping a screenshot each time the screen has held
+// still for stable_needed frames
+static int collect_stable_screens(int max_frames, int stable_needed, std::vector<Candidate> &candidates)
+{
+    uint64_t prev_hash = 0;
+    bool have_prev = false;
+    int stable = 0, total = 0;
+
+    while (total < max_frames)
+    {
+        Emulator::RunFrame();
+        total++;
+
+        uint64_t hash = frame_hash();
+        if (have_prev && hash == prev_hash)
+        {
+            if (++stable == stable_needed)
+            {
+                int complexity = screen_complexity();
+                if (complexity >= 4)
+                    candidates.push_back({ capture_screen(), complexity, total });
+            }
+        }
+        else
+        {
+            stable = 0;
+            prev_hash = hash;
+            have_prev = true;
+        }
+    }
+    return total;
+}
+
+static void press_start()
+{
+    Emulator::SetButtonState(0, SNES_START_MASK);
+    run_frames(10);
+    Emulator::SetButtonState(0, 0);
+}
+
+static const Candidate *most_complex(const std::vector<Candidate> &candidates)
+{
+    const Candidate *best = nullptr;
+    for (const Candidate &c : candidates)
+    {
+        if (!best || c.complexity > best->complexity)
+            best = &c;
+    }
+    return best;
+}
+
+static Screen capture_title_screen(char *strategy, size_t size)
+{
+    std::vector<Candidate> candidates;
+
+    // Skip the boot, then collect stable screens for ~28 seconds
+    run_frames(60);
+    collect_stable_screens(1740, 45, candidates);
+
+    const Candidate *best = most_complex(candidates);
+    if (best && best->complexity >= 60)
+    {
+        snprintf(strategy, size, "best of %zu stable screens at %df (%d colors)",
+                 candidates.size(), 60 + best->frame, best->complexity);
+        return best->screen;
+    }
+
+    // Press Start to get past intros and logos to a menu
+    press_start();
+    collect_stable_screens(900, 45, candidates);
+
+    best = most_complex(candidates);
+    if (best && best->complexity >= 60)
+    {
+        snprintf(strategy, size, "after Start, best of %zu (%d colors)", candidates.size(), best->complexity);
+        return best->screen;
+    }
+
+    // Some games need two presses
+    press_start();
+    collect_stable_screens(600, 45, candidates);
+
+    best = most_complex(candidates);
+    if (best)
+    {
+        snprintf(strategy, size, "best of %zu after 2x Start (%d colors)", candidates.size(), best->complexity);
+        return best->screen;
+    }
+
+    // Last resort: whatever is on screen
+    run_frames(300);
+    snprintf(strategy, size, "%s", screen_complexity() < 4 ? "blank" : "best effort");
+    return capture_screen();
+}
+
+static Screen capture_fixed(double seconds, char *strategy, size_t size)
+{
+    run_frames((int)(seconds * 60));
+    snprintf(strategy, size, "fixed %gs", seconds);
+    return capture_screen();
+}
+
+// ---------------------------------------------------------------------------
+// Worker
+// ---------------------------------------------------------------------------
+
+// Header name to a file name: alphanumerics, runs of anything else become
+// one underscore
+static std::string sanitize(const std::string &name)
+{
+    std::string out;
+    for (unsigned char c : name)
+    {
+        if (c < 0x80 && isalnum(c))
+            out += (char)c;
+        else if (!out.empty() && out.back() != '_')
+            out += '_';
+    }
+    while (!out.empty() && out.back() == '_')
+        out.pop_back();
+    return out;
+}
+
+static std::string lower(std::string s)
+{
+    for (char &c : s)
+        c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+static std::string strip(const char *s)
+{
+    std::string str(s);
+    size_t a = str.find_first_not_of(" \t\r\n");
+    size_t b = str.find_last_not_of(" \t\r\n");
+    return a == std::string::npos ? std::string() : str.substr(a, b - a + 1);
+}
+
+static bool copy_file(const std::string &from, const std::string &to)
+{
+    FILE *in = fopen(from.c_str(), "rb");
+    if (!in)
+        return false;
+    FILE *out = fopen(to.c_str(), "wb");
+    if (!out)
+    {
+        fclose(in);
+        return false;
+    }
+
+    char buf[65536];
+    size_t n;
+    bool ok = true;
+    while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+        ok = fwrite(buf, 1, n, out) == n;
+    fclose(in);
+    return fclose(out) == 0 && ok;
+}
+
+static void process_rom(const Options &opt, const std::string &path, Job &job)
+{
+    if (!Emulator::LoadROM(path.c_str()))
+    {
+        job.state = JOB_FAILED;
+        return;
+    }
+
+    std::string name = strip(Emulator::GetROMName());
+    std::string safe = sanitize(name);
+    std::string base = opt.output_dir + "/" + job.filename;
+    snprintf(job.name, sizeof(job.name), "%s", name.c_str());
+    job.pal = Emulator::IsPAL();
+
+    const double *override_secs = nullptr;
+    for (const auto &o : opt.overrides)
+    {
+        if (lower(sanitize(o.first)) == lower(safe))
+        {
+            override_secs = &o.second;
+            break;
+        }
+    }
+
+    Screen screen = override_secs ? capture_fixed(*override_secs, job.strategy, sizeof(job.strategy))
+                                  : capture_title_screen(job.strategy, sizeof(job.strategy));
+
+    if (!write_png(base + ".png", screen.rgb.data(), screen.width, screen.height))
+    {
+        job.state = JOB_FAILED;
+        return;
+    }
+
+    if (opt.copy_roms)
+        copy_file(path, base + ".sfc");
+
+    job.state = JOB_DONE;
+}
+
+// Give every game its own output name before the workers start, so that two
+// releases with the same header title never write the same files at once.
+// A taken name gets the header checksum appended, then a number; a title
+// with nothing usable in it falls back to the file name.
+static void assign_filenames(const std::vector<std::string> &roms, const std::vector<SROMProbe> &probes,
+                             WorkTable *table)
+{
+    std::set<std::string> taken;   // Lowercase: the output may be on a case-insensitive disk
+
+    for (size_t i = 0; i < roms.size(); i++)
+    {
+        std::string name = sanitize(strip(probes[i].Name));
+        if (name.empty())
+        {
+            const char *file = strrchr(roms[i].c_str(), '/');
+            std::string stem = file ? file + 1 : roms[i];
+            name = sanitize(stem.substr(0, stem.rfind('.')));
+        }
+        if (name.empty())
+            name = "ROM";
+        name.resize(std::min(name.size(), (size_t)40));
+
+        char checksum[8];
+        snprintf(checksum, sizeof(checksum), "_%04x", probes[i].Checksum);
+        std::string unique = name;
+        if (taken.count(lower(unique)))
+            unique = name + checksum;
+        for (int n = 2; taken.count(lower(unique)); n++)
+            unique = name + checksum + "_" + std::to_string(n);
+        taken.insert(lower(unique));
+
+        snprintf(table->jobs[i].filename, sizeof(table->jobs[i].filename), "%s", unique.c_str());
+    }
+}
+
+static void worker_main(const Options &opt, const std::vector<std::string> &roms, WorkTable *table)
+{
+    if (!opt.verbose)
+        freopen("/dev/null", "w", stderr);
+
+    if (!Emulator::Init(opt.config.c_str()))
+        _exit(1);
+
+    for (;;)
+    {
+        int i = table->next++;
+        if (i >= (int)roms.size())
+            break;
+
+        Job &job = table->jobs[i];
+        job.worker = getpid();
+        job.state = JOB_RUNNING;
+        process_rom(opt, roms[i], job);
+    }
+
+    // No Shutdown(): it would write each last game's SRAM next to the ROM
+    _exit(0);
+}
+
+// ---------------------------------------------------------------------------
+// Manifest
+// ---------------------------------------------------------------------------
+
+static std::string json_string(const std::string &s)
+{
+    std::string out = "\"";
+    for (unsigned char c : s)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += (char)c;
+        }
+        else if (c >= 0x80)
+            out += "\\ufffd";   // Header names are ASCII; anything else is garbage
+        else if (c < 0x20)
+        {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        }
+        else
+            out += (char)c;
+    }
+    return out + "\"";
+}
+
+static bool write_manifest(const Options &opt, const std::vector<std::string> &roms,
+                           const std::vector<SROMProbe> &probes, const WorkTable *table, int *written)
+{
+    char generated[32];
+    time_t now = time(nullptr);
+    strftime(generated, sizeof(generated), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    std::string json = "{\n  \"generated\": \"" + std::string(generated) + "\",\n  \"roms\": [";
+    int count = 0;
+
+    for (size_t i = 0; i < roms.size(); i++)
+    {
+        const Job &job = table->jobs[i];
+        if (job.state != JOB_DONE)
+            continue;
+
+        char checksum[8];
+        snprintf(checksum, sizeof(checksum), "%04x", probes[i].Checksum);
+
+        json += count++ ? ",\n    {\n" : "\n    {\n";
+        json += "      \"original_path\": " + json_string(roms[i]) + ",\n";
+        json += "      \"game_name\": " + json_string(job.name) + ",\n";
+        json += "      \"filename\": " + json_string(job.filename) + ",\n";
+        json += "      \"region\": " + json_string(job.pal ? "PAL" : "NTSC") + ",\n";
+        json += "      \"map_type\": " + json_string(probes[i].MapType) + ",\n";
+        json += "      \"contents\": " + json_string(probes[i].Contents) + ",\n";
+        json += "      \"checksum\": " + json_string(checksum) + ",\n";
+        json += "      \"screenshot_strategy\": " + json_string(job.strategy) + "\n    }";
+    }
+    json += count ? "\n  ]\n}" : "]\n}";
+
+    *written = count;
+    FILE *f = fopen((opt.output_dir + "/metadata.json").c_str(), "w");
+    if (!f)
+        return false;
+    bool ok = fwrite(json.data(), 1, json.size(), f) == json.size();
+    return fclose(f) == 0 && ok;
+}
+
+// ---------------------------------------------------------------------------
+// Main
+// ---------------------------------------------------------------------------
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: snes9x-covers [options] ROM|DIR...\n"
+            "  -o, --output-dir DIR      where PNGs and metadata.json go (default ./output)\n"
+            "  -j, --jobs N              worker processes (default: one per core)\n"
+            "      --list FILE           also read ROM paths from FILE, one per line (- = stdin)\n"
+            "      --config FILE         emulator config for the workers\n"
+            "      --copy-roms           copy ROMs to the output dir with normalized names\n"
+            "      --override NAME=SECS  fixed capture time for one game\n"
+            "  -v, --verbose             show emulator messages\n");
+}
+
+static void add_rom(const std::string &path, std::vector<std::string> &roms, std::vector<SROMProbe> &probes)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        std::vector<std::string> paths;
+        std::vector<SROMProbe> results;
+        S9xProbeROMDirectory(path.c_str(), true, 0, paths, results);
+        roms.insert(roms.end(), paths.begin(), paths.end());
+        probes.insert(probes.end(), results.begin(), results.end());
+        return;
+    }
+
+    SROMProbe probe;
+    S9xProbeROM(path.c_str(), &probe);
+    roms.push_back(path);
+    probes.push_back(probe);
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc)
+            {
+                usage();
+                exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-o" || arg == "--output-dir")
+            opt.output_dir = value();
+        else if (arg == "-j" || arg == "--jobs")
+            opt.workers = atoi(value().c_str());
+        else if (arg.compare(0, 2, "-j") == 0)
+            opt.workers = atoi(arg.c_str() + 2);
+        else if (arg == "--config")
+            opt.config = value();
+        else if (arg == "--copy-roms")
+            opt.copy_roms = true;
+        else if (arg == "-v" || arg == "--verbose")
+            opt.verbose = true;
+        else if (arg == "--override")
+        {
+            std::string o = value();
+            size_t eq = o.rfind('=');
+            if (eq == std::string::npos)
+            {
+                fprintf(stderr, "--override must be NAME=SECONDS, got: %s\n", o.c_str());
+                return 2;
+            }
+            opt.overrides.push_back({ o.substr(0, eq), atof(o.c_str() + eq + 1) });
+        }
+        else if (arg == "--list")
+        {
+            std::string file = value();
+            FILE *f = file == "-" ? stdin : fopen(file.c_str(), "r");
+            if (!f)
+            {
+                fprintf(stderr, "Can't read %s\n", file.c_str());
+                return 1;
+            }
+            char line[4096];
+            while (fgets(line, sizeof(line), f))
+            {
+                std::string path = strip(line);
+                if (!path.empty())
+                    inputs.push_back(path);
+            }
+            if (f != stdin)
+                fclose(f);
+        }
+        else if (arg == "-h" || arg == "--help")
+        {
+            usage();
+            return 0;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else
+            inputs.push_back(arg);
+    }
+
+    if (inputs.empty())
+    {
+        usage();
+        return 2;
+    }
+
+    // Workers can't report a bad config (their stderr is closed), so check it here
+    S9xConfig config;
+    if (!opt.config.empty() && !S9xLoadConfig(opt.config.c_str(), config))
+    {
+        fprintf(stderr, "Can't read config file %s\n", opt.config.c_str());
+        return 2;
+    }
+
+    // Probe headers first, so files that aren't SNES ROMs never reach a worker
+    std::vector<std::string> roms;
+    std::vector<SROMProbe> probes;
+    for (const std::string &in : inputs)
+        add_rom(in, roms, probes);
+
+    for (size_t i = 0; i < roms.size(); )
+    {
+        if (probes[i].Valid)
+        {
+            i++;
+            continue;
+        }
+        fprintf(stderr, "  SKIP: no SNES header in %s\n", roms[i].c_str());
+        roms.erase(roms.begin() + i);
+        probes.erase(probes.begin() + i);
+    }
+
+    printf("Found %zu ROMs\n", roms.size());
+    if (roms.empty())
+        return 1;
+
+    mkdir(opt.output_dir.c_str(), 0755);
+
+    int workers = opt.workers > 0 ? opt.workers : (int)std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, (int)roms.size());
+
+    size_t table_size = sizeof(WorkTable) + sizeof(Job) * roms.size();
+    WorkTable *table = (WorkTable *)mmap(nullptr, table_size, PROT_READ | PROT_WRITE,
+                                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (table == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+
+    assign_filenames(roms, probes, table);
+
+    fflush(stdout);
+    int running = 0;
+    auto spawn = [&]() {
+        pid_t pid = fork();
+        if (pid == 0)
+            worker_main(opt, roms, table);
+        if (pid > 0)
+            running++;
+        return pid > 0;
+    };
+    for (int i = 0; i < workers; i++)
+        spawn();
+
+    // Report games as they finish. A worker that crashes takes only the game
+    // it was on with it; a replacement carries on with the rest, unless
+    // workers keep dying without any game being finished in between.
+    const int max_deaths = 8;
+    int deaths = 0;     // Workers killed since a game last finished
+    size_t reported = 0;
+    while (running > 0 || reported < roms.size())
+    {
+        int status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+
+        if (pid > 0)
+        {
+            running--;
+
+            for (size_t i = 0; i < roms.size(); i++)
+            {
+                Job &job = table->jobs[i];
+                if (job.worker == pid && job.state == JOB_RUNNING)
+                    job.state = JOB_CRASHED;
+            }
+
+            if (WIFSIGNALED(status) && table->next < (int)roms.size())
+            {
+                if (++deaths <= max_deaths)
+                    spawn();
+                else if (deaths == max_deaths + 1)
+                    fprintf(stderr, "  Workers keep crashing; not starting any more\n");
+            }
+        }
+
+        for (size_t i = 0; i < roms.size(); i++)
+        {
+            Job &job = table->jobs[i];
+            int state = job.state;
+            if (job.reported || state == JOB_PENDING || state == JOB_RUNNING)
+                continue;
+
+            job.reported = true;
+            reported++;
+            if (state != JOB_CRASHED)
+                deaths = 0;
+            const char *base = strrchr(roms[i].c_str(), '/');
+            base = base ? base + 1 : roms[i].c_str();
+            if (state == JOB_DONE)
+                printf("  %s -> %s  (%s)\n", base, job.filename, job.strategy);
+            else if (state == JOB_CRASHED)
+                fprintf(stderr, "  SKIP: emulator crashed on %s\n", base);
+            else
+                fprintf(stderr, "  SKIP: failed to load %s\n", base);
+            fflush(stdout);
+        }
+
+        if (running == 0 && reported < roms.size())
+        {
+            // Nobody left to finish these: every worker exited before taking
+            // them (Init() failed, or no more were started after crashes), or
+            // died between taking a game and marking it
+            fprintf(stderr, "  No workers left for the remaining %zu games\n", roms.size() - reported);
+            for (size_t i = 0; i < roms.size(); i++)
+            {
+                if (table->jobs[i].state == JOB_PENDING || table->jobs[i].state == JOB_RUNNING)
+                    table->jobs[i].state = JOB_FAILED;
+            }
+            continue;
+        }
+
+        if (pid <= 0)
+            usleep(20000);
+    }
+
+    int written = 0;
+    if (!write_manifest(opt, roms, probes, table, &written))
+    {
+        fprintf(stderr, "Can't write %s/metadata.json\n", opt.output_dir.c_str());
+        return 1;
+    }
+    printf("\nWrote %s/metadata.json (%d ROMs)\n", opt.output_dir.c_str(), written);
+
+    munmap(table, table_size);
+    return 0;
+}